@@ -0,0 +1,105 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// concurrent_cache_bench.cc - [benchmark] contention of ConcurrentCache
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+// Reports throughput of lookups into ConcurrentCache by 1 to 64
+// threads, with a single shard and with the default number of shards.
+// Every thread looks up pseudo-random keys from a small key space, so
+// almost all lookups hit, and time is dominated by synchronization.
+
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+
+#include "concurrent_cache.hh"
+#include "thread_pool.hh"
+#include "typedef.hh"
+
+
+int main() {
+
+  using ::esf::Index;
+  using ::std::cout;
+  using ::std::setw;
+
+  typedef ::std::chrono::steady_clock clock;
+
+  Index const keys = 4096, lookups = 200000;
+
+  cout << setw(8) << "shards" << setw(10) << "threads" << setw(12) << "time[ms]"
+       << setw(16) << "lookups/us" << setw(10) << "waits" << '\n';
+
+  for (::std::size_t shards: {1, 64}) {
+
+    for (Index threads = 1; threads <= 64; threads *= 2) {
+
+      ::esf::ConcurrentCache<Index, double> cache(shards);
+
+      ::esf::ThreadPool pool(threads);
+
+      auto start = clock::now();
+
+      pool.parallel_for_each(
+          0, threads,
+          [&cache](Index t)
+          {
+            ::std::uint64_t x = 0x9e3779b97f4a7c15ULL * static_cast<::std::uint64_t>(t + 1);
+
+            double sum = 0.0;
+
+            for (Index i = 0; i < lookups; ++i) {
+
+              x ^= x << 13;
+              x ^= x >> 7;
+              x ^= x << 17;
+
+              auto key = static_cast<Index>(x % keys);
+
+              sum += cache.get_or_compute(key, [key]() { return key * 0.5; });
+
+            }
+
+            if (sum < 0.0) {
+
+              cout << sum;
+
+            }
+          });
+
+      auto stop = clock::now();
+
+      double us = ::std::chrono::duration<double, ::std::micro>(stop - start).count();
+
+      cout << setw(8) << shards << setw(10) << threads << setw(12) << us / 1000.0
+           << setw(16) << threads * lookups / us
+           << setw(10) << cache.stats().waits << '\n';
+
+    }
+
+  }
+
+  return 0;
+
+}
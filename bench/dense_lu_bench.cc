@@ -0,0 +1,140 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// dense_lu_bench.cc - [benchmark] dense and sparse direct solvers
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+// Compares the time of computing hitting probabilities by sparse and
+// dense LU decomposition for small initial conditions.  The crossover
+// is where the last column changes from "dense" to "sparse", and it
+// gives the default of SolverOption::dense_threshold.
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "hit_prob.hh"
+#include "init.hh"
+#include "param.hh"
+#include "typedef.hh"
+
+namespace {
+
+
+using ::esf::Index;
+
+
+::esf::Param make_param(Index deme) {
+
+  using ::std::vector;
+
+  auto n = ::esf::unsign(deme);
+
+  vector<double> mig(n * n, 0.5), pop(n, 1.0), mut(n, 0.5);
+
+  for (decltype(n) i = 0; i < n; ++i) {
+
+    mig[i + i * n] = 0.0;
+
+  }
+
+  return ::esf::Param(mig, pop, mut);
+
+}
+
+
+// Returns average time in microseconds of computing hitting
+// probabilities with a solver.
+double time_solver(::esf::Init const& init, ::esf::Param const& param,
+                   ::esf::SolverType type) {
+
+  typedef ::std::chrono::steady_clock clock;
+
+  ::esf::SolverOption option(type, 0.0, 0, 1, 0);
+
+  Index count = 0;
+
+  auto start = clock::now();
+  auto stop = start;
+
+  do {
+
+    ::esf::HitProb hp(init, param, option);
+
+    ++count;
+
+    stop = clock::now();
+
+  } while (stop - start < ::std::chrono::milliseconds(200));
+
+  return ::std::chrono::duration<double, ::std::micro>(stop - start).count() / count;
+
+}
+
+
+}
+
+
+int main() {
+
+  using ::std::cout;
+  using ::std::setw;
+  using ::std::vector;
+
+  vector<vector<Index>> inits =
+      {
+        {1, 1}, {2, 2}, {3, 3}, {1, 1, 1}, {5, 5}, {7, 7}, {2, 1, 1},
+        {9, 9}, {2, 2, 1}, {14, 14}, {2, 2, 2}, {3, 2, 2}, {3, 3, 2},
+        {3, 3, 3}
+      };
+
+  cout << setw(12) << "init" << setw(8) << "dim" << setw(14) << "sparse[us]"
+       << setw(14) << "dense[us]" << setw(10) << "faster" << '\n';
+
+  for (auto const& data: inits) {
+
+    ::esf::Init init(data);
+
+    auto param = make_param(init.deme());
+
+    double sparse = time_solver(init, param, ::esf::SolverType::SparseLU);
+    double dense = time_solver(init, param, ::esf::SolverType::DenseLU);
+
+    ::std::ostringstream name;
+
+    for (decltype(data.size()) i = 0; i < data.size(); ++i) {
+
+      name << (i == 0 ? "" : ",") << data[i];
+
+    }
+
+    cout << setw(12) << name.str() << setw(8) << init.dim()
+         << setw(14) << sparse << setw(14) << dense
+         << setw(10) << (dense < sparse ? "dense" : "sparse") << '\n';
+
+  }
+
+  return 0;
+
+}
@@ -0,0 +1,104 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_engine_bench.cc - [benchmark] parallel evaluation of ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+// Reports time of evaluating samples of increasing size by ESFEngine
+// with increasing numbers of threads, and speed-up relative to a
+// single thread.  The maximum number of threads is given as the first
+// argument, and it defaults to the number of hardware threads.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "esf_engine.hh"
+#include "param.hh"
+#include "typedef.hh"
+
+
+int main(int argc, char** argv) {
+
+  using ::esf::AFS;
+  using ::esf::Allele;
+  using ::esf::Index;
+  using ::std::cout;
+  using ::std::setw;
+  using ::std::vector;
+
+  typedef ::std::chrono::steady_clock clock;
+
+  Index max_threads = argc > 1
+    ? ::std::atol(argv[1])
+    : static_cast<Index>(::std::thread::hardware_concurrency());
+
+  ::esf::Param param({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4});
+
+  vector<AFS> samples = {
+    AFS(vector<Allele>({Allele({2, 1}), Allele({1, 1}), Allele({0, 1})})),
+    AFS(vector<Allele>({Allele({3, 1}), Allele({1, 2}), Allele({1, 0}), Allele({0, 1})})),
+    AFS(vector<Allele>({Allele({3, 2}), Allele({2, 2}), Allele({1, 0}), Allele({0, 1})})),
+  };
+
+  cout << setw(8) << "genes" << setw(10) << "nodes" << setw(10) << "threads"
+       << setw(12) << "time[ms]" << setw(10) << "speed-up" << '\n';
+
+  for (auto const& afs: samples) {
+
+    double base = 0.0;
+
+    for (Index threads = 1; threads <= ::std::max<Index>(1, max_threads); threads *= 2) {
+
+      ::esf::ESFEngine engine(param, ::esf::SolverOption(), threads);
+
+      auto start = clock::now();
+
+      engine.compute(afs);
+
+      auto stop = clock::now();
+
+      double ms = ::std::chrono::duration<double, ::std::milli>(stop - start).count();
+
+      if (threads == 1) {
+
+        base = ms;
+
+      }
+
+      cout << setw(8) << afs.size() << setw(10) << engine.nodes()
+           << setw(10) << threads << setw(12) << ms
+           << setw(10) << base / ms << '\n';
+
+    }
+
+  }
+
+  return 0;
+
+}
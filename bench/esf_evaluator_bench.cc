@@ -0,0 +1,139 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_evaluator_bench.cc - [benchmark] re-evaluation of compiled ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+// Reports time of compiling the recursion of a sample, of mapping a
+// saved graph, and of evaluating it for a sequence of parameters as in
+// likelihood optimization, compared with the recursive ESFProb.
+
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "esf_evaluator.hh"
+#include "esf_graph.hh"
+#include "esf_prob.hh"
+#include "param.hh"
+
+
+int main() {
+
+  using ::esf::AFS;
+  using ::esf::Allele;
+  using ::esf::Param;
+  using ::std::cout;
+  using ::std::setw;
+  using ::std::vector;
+
+  typedef ::std::chrono::steady_clock clock;
+
+  auto elapsed = [](clock::time_point start)
+    {
+      return ::std::chrono::duration<double, ::std::milli>(clock::now() - start).count();
+    };
+
+  vector<AFS> samples = {
+    AFS(vector<Allele>({Allele({2, 1}), Allele({1, 1}), Allele({0, 1})})),
+    AFS(vector<Allele>({Allele({3, 1}), Allele({1, 2}), Allele({1, 0}), Allele({0, 1})})),
+    AFS(vector<Allele>({Allele({3, 2}), Allele({2, 2}), Allele({1, 0}), Allele({0, 1})})),
+  };
+
+  vector<Param> params;
+
+  for (int i = 0; i < 10; ++i) {
+
+    double m = 0.5 + 0.1 * i;
+
+    params.push_back(Param({0.0, m, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4}));
+
+  }
+
+  cout << setw(8) << "genes" << setw(10) << "nodes" << setw(10) << "terms"
+       << setw(14) << "compile[ms]" << setw(10) << "map[ms]" << setw(12) << "first[ms]"
+       << setw(12) << "next[ms]" << setw(14) << "ESFProb[ms]" << '\n';
+
+  for (auto const& afs: samples) {
+
+    auto start = clock::now();
+
+    auto graph = ::std::make_shared<::esf::ESFGraph>(afs);
+
+    double compile = elapsed(start);
+
+    ::std::string path("esf_evaluator_bench.graph");
+
+    graph->save(path);
+
+    start = clock::now();
+
+    graph = ::std::make_shared<::esf::ESFGraph>(::esf::ESFGraph::map(path));
+
+    double map = elapsed(start);
+
+    ::std::remove(path.c_str());
+
+    ::esf::ESFEvaluator evaluator(graph);
+
+    start = clock::now();
+
+    evaluator.compute(params[0]);
+
+    double first = elapsed(start);
+
+    start = clock::now();
+
+    for (decltype(params.size()) i = 1; i < params.size(); ++i) {
+
+      evaluator.compute(params[i]);
+
+    }
+
+    double next = elapsed(start) / (params.size() - 1);
+
+    start = clock::now();
+
+    for (auto const& p: params) {
+
+      ::esf::ESFProb(afs, p).compute();
+
+    }
+
+    double recursion = elapsed(start) / params.size();
+
+    cout << setw(8) << afs.size() << setw(10) << graph->nodes()
+         << setw(10) << graph->terms().size() << setw(14) << compile
+         << setw(10) << map << setw(12) << first << setw(12) << next
+         << setw(14) << recursion << '\n';
+
+  }
+
+  return 0;
+
+}
@@ -0,0 +1,101 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hash_bench.cc - [benchmark] distribution of keys in caches
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+// Evaluates samples with ESFProb and reports how keys of the caches
+// of ESF probabilities and hitting probabilities are spread over
+// buckets: the number of buckets by length, the fraction of keys
+// sharing a bucket, the fraction of keys sharing a full hash, and
+// the average number of keys visited by a successful lookup.
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "esf_prob.hh"
+#include "hash.hh"
+#include "param.hh"
+
+
+namespace {
+
+void report(::std::string const& name, ::esf::HashDiagnostics const& diag) {
+
+  using ::std::cout;
+  using ::std::setw;
+
+  cout << name << ": " << diag.keys << " keys in " << diag.buckets
+       << " buckets\n";
+
+  cout << "  bucket collision rate " << diag.bucket_collision_rate
+       << ", hash collision rate " << diag.hash_collision_rate
+       << ", mean probe " << diag.mean_probe << '\n';
+
+  for (decltype(diag.bucket_lengths.size()) i = 0;
+       i < diag.bucket_lengths.size(); ++i) {
+
+    cout << setw(8) << i << setw(12) << diag.bucket_lengths[i] << '\n';
+
+  }
+
+}
+
+}
+
+
+int main() {
+
+  using ::esf::AFS;
+  using ::esf::Allele;
+  using ::std::cout;
+  using ::std::vector;
+
+  ::esf::Param param({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4});
+
+  vector<AFS> samples = {
+    AFS(vector<Allele>({Allele({3, 1}), Allele({1, 2}), Allele({1, 0}), Allele({0, 1})})),
+    AFS(vector<Allele>({Allele({3, 2}), Allele({2, 2}), Allele({1, 0}), Allele({0, 1})})),
+  };
+
+  for (auto const& afs: samples) {
+
+    ::esf::ESFProb prob(afs, param);
+
+    prob.compute();
+
+    cout << "sample of " << afs.size() << " genes\n";
+
+    report("ESF probabilities", prob.esf_prob_cache_diagnostics());
+    report("hitting probabilities", prob.hit_prob_cache_diagnostics());
+
+    cout << '\n';
+
+  }
+
+  return 0;
+
+}
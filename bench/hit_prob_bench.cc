@@ -0,0 +1,122 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hit_prob_bench.cc - [benchmark] assembly of generator
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+// Reports time and peak resident set size of assembling the generator
+// for initial conditions of increasing size.  The peak is the high
+// water mark of the whole process.  Sizes are visited in increasing
+// order, so each row reflects the largest assembly done so far.
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "generator.hh"
+#include "init.hh"
+#include "param.hh"
+#include "typedef.hh"
+
+namespace {
+
+
+using ::esf::Index;
+
+
+long peak_rss_kb() {
+
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+
+  return usage.ru_maxrss;
+
+}
+
+
+::esf::Param make_param(Index deme) {
+
+  using ::std::vector;
+
+  auto n = ::esf::unsign(deme);
+
+  vector<double> mig(n * n, 0.5), pop(n, 1.0), mut(n, 0.5);
+
+  for (decltype(n) i = 0; i < n; ++i) {
+
+    mig[i + i * n] = 0.0;
+
+  }
+
+  return ::esf::Param(mig, pop, mut);
+
+}
+
+
+}
+
+
+int main() {
+
+  using ::std::cout;
+  using ::std::setw;
+  using ::std::vector;
+
+  typedef ::std::chrono::steady_clock clock;
+
+  cout << setw(6) << "deme" << setw(8) << "genes" << setw(12) << "dim"
+       << setw(12) << "nnz" << setw(14) << "assembly[ms]"
+       << setw(16) << "peak RSS[KiB]" << '\n';
+
+  for (Index deme = 2; deme <= 4; ++deme) {
+
+    auto param = make_param(deme);
+
+    for (Index genes = 2; genes <= (deme == 4 ? 3 : 10); ++genes) {
+
+      ::esf::Init init(vector<Index>(::esf::unsign(deme), genes));
+
+      vector<double> coals;
+
+      auto start = clock::now();
+
+      auto u = ::esf::assemble_generator(init, param, coals);
+
+      auto stop = clock::now();
+
+      double ms = ::std::chrono::duration<double, ::std::milli>(stop - start).count();
+
+      cout << setw(6) << deme << setw(8) << genes << setw(12) << init.dim()
+           << setw(12) << u.nonZeros() << setw(14) << ms
+           << setw(16) << peak_rss_kb() << '\n';
+
+    }
+
+  }
+
+  return 0;
+
+}
@@ -26,6 +26,7 @@
 #include <algorithm>
 #include <iostream>
 #include <iterator>
+#include <memory>
 #include <numeric>
 #include <stdexcept>
 #include <utility>
@@ -33,61 +34,160 @@
 
 #include "afs.hh"
 #include "allele.hh"
+#include "hash.hh"
 #include "init.hh"
+#include "state_space.hh"
 #include "util.hh"
 
 namespace esf {
 
 
+AFS::AFS()
+    : m_size(0), m_hash(0) {}
+
+
 AFS::AFS(::std::vector<Allele> const& avec) {
 
-  for (auto allele: avec) {
+  auto sorted = avec;
+
+  ::std::sort(sorted.begin(), sorted.end());
+
+  for (auto const& allele: sorted) {
+
+    if (!m_data.empty() && m_data.back().first == allele) {
+
+      ++m_data.back().second;
+
+    } else {
+
+      m_data.emplace_back(allele, 1);
+
+    }
+
+  }
+
+  m_sizes.resize(avec.empty() ? 0 : unsign(avec.front().deme()));
+
+  set_summary();
+
+}
+
+
+AFS::AFS(AFS::data_type const& data, Index deme)
+    : m_data(data), m_sizes(unsign(deme)) {
+
+  set_summary();
+
+}
+
+
+void AFS::set_summary() {
+
+  ::std::fill(m_sizes.begin(), m_sizes.end(), 0);
+
+  m_size = 0;
+
+  // The hash adds up shares of alleles, which do not depend on the
+  // order of alleles.
+  auto hash = static_cast<::std::size_t>(hash_mix(unsign(deme())));
+
+  for (auto const& elem: m_data) {
+
+    for (decltype(m_sizes.size()) d = 0; d < m_sizes.size(); ++d) {
+
+      m_sizes[d] += elem.first[sign(d)] * elem.second;
+
+    }
+
+    hash += entry_hash(elem);
 
-    m_data[allele] += 1;
+    m_size += elem.first.size() * elem.second;
 
   }
 
+  m_hash = hash;
+
 }
 
 
-AFS::AFS(AFS::data_type const& data)
-    : m_data(data) {}
+::std::size_t AFS::entry_hash(value_type const& elem) {
+
+  auto hash = hash_combine(::std::hash<Allele>()(elem.first), unsign(elem.second));
+
+  return static_cast<::std::size_t>(hash);
+
+}
+
+
+AFS::const_iterator AFS::find(Allele const& allele) const {
+
+  auto itr = ::std::lower_bound(m_data.begin(), m_data.end(), allele,
+                                [](value_type const& p, Allele const& a)
+                                {
+                                  return p.first < a;
+                                });
+
+  return itr != m_data.end() && itr->first == allele ? itr : m_data.end();
+
+}
 
 
 AFS AFS::add(Allele const& allele) const {
 
+  if (allele.size() == 0) {
+
+    return *this;
+
+  }
+
   auto data = m_data;
 
-  if (allele.size() > 0) {
+  auto itr = ::std::lower_bound(data.begin(), data.end(), allele,
+                                [](value_type const& p, Allele const& a)
+                                {
+                                  return p.first < a;
+                                });
+
+  if (itr != data.end() && itr->first == allele) {
+
+    ++itr->second;
 
-    ++data[allele];
+  } else {
+
+    data.emplace(itr, allele, 1);
 
   }
 
-  return AFS(data);
+  return AFS(data, m_sizes.empty() ? allele.deme() : deme());
 
 }
 
 
 AFS AFS::remove(Allele const& allele) const {
 
-  auto data = m_data;
+  auto itr = find(allele);
 
-  if (allele.size() > 0) {
+  if (allele.size() == 0 || itr == m_data.end()) {
 
-    if (data[allele] > 1) {
+    return *this;
 
-      --data[allele];
+  }
 
-    } else {
+  auto data = m_data;
 
-      data.erase(allele);
+  auto pos = data.begin() + (itr - m_data.begin());
 
-    }
+  if (pos->second > 1) {
+
+    --pos->second;
+
+  } else {
+
+    data.erase(pos);
 
   }
 
-  return AFS(data);
+  return AFS(data, deme());
 
 }
 
@@ -95,7 +195,7 @@ AFS AFS::remove(Allele const& allele) const {
 bool AFS::singleton() const {
 
   return ::std::any_of(m_data.begin(), m_data.end(),
-                       [](value_type p)
+                       [](value_type const& p)
                        {
                          return p.first.singleton();
                        }
@@ -106,149 +206,208 @@ bool AFS::singleton() const {
 
 Index AFS::operator[](const Allele& allele) const {
 
-  try {
-
-    return m_data.at(allele);
-
-  } catch (::std::out_of_range&) {
-
-    return 0;
+  auto itr = find(allele);
 
-  }
+  return itr == m_data.end() ? 0 : itr->second;
 
 }
 
 
 Index AFS::size(Index deme) const {
 
-  Index start = 0;
-  return ::std::accumulate(m_data.begin(), m_data.end(), start,
-                           [deme](Index a, value_type p)
-                           {
-                             return a + (p.first)[deme] * p.second;
-                           }
-                           );
+  return m_sizes[unsign(deme)];
 
 }
 
 
 Index AFS::size() const {
 
-  Index start = 0;
-  return ::std::accumulate(this->begin(), this->end(), start,
-                           [](Index a, value_type p)
-                           {
-                             return a + (p.first).size() * p.second;
-                           }
-                           );
+  return m_size;
+
 }
 
 
 Index AFS::deme() const {
 
-  return m_data.begin()->first.deme();
+  return sign(m_sizes.size());
+
+}
+
+
+AFS::layer_type AFS::layer() const {
+
+  Index singletons = 0;
+
+  for (auto const& a: m_data) {
+
+    if (a.first.singleton()) {
+
+      singletons += a.second;
+
+    }
+
+  }
+
+  return {m_size, singletons};
+
+}
+
+
+::std::size_t AFS::hash() const {
+
+  return m_hash;
 
 }
 
 
 ::std::vector<ExitAFSPair> AFS::reacheable() const {
 
-  using ::std::vector;
+  ::std::vector<ExitAFSPair> retval;
 
-  vector<Allele> alleles;
-  vector<Index> state_vec(unsign(deme() * deme()));
+  reacheable([&retval](AFS const& afs, State const& state)
+             {
+               retval.push_back(ExitAFSPair({afs, state}));
+             });
 
-  return build(alleles, state_vec, m_data.begin(), m_data.end());
+  return retval;
 
 }
 
 
-::std::vector<ExitAFSPair> AFS::build(::std::vector<Allele> alleles,
-                                      ::std::vector<Index> states,
-                                      data_type::const_iterator begin,
-                                      data_type::const_iterator end) const {
+void AFS::reacheable(visitor_type const& visit) const {
 
-  if (begin == end) {
+  // Alleles of AFS are distinct, and each is expanded once here.
+  ::std::vector<::std::vector<ExitAllelePair>> expansions;
 
-    return {ExitAFSPair({AFS(alleles), State(Init(*this), states)})};
+  expansions.reserve(m_data.size());
+
+  exits_type exits;
+
+  for (auto const& a: m_data) {
+
+    expansions.push_back(a.first.reacheable());
+
+    exits.push_back(&expansions.back());
 
   }
 
-  auto reacheables = begin->first.reacheable();
+  walk(exits, visit);
+
+}
+
+
+void AFS::reacheable(visitor_type const& visit, AlleleExitCache& cache) const {
 
-  auto itr_b = reacheables.begin();
-  auto itr_e = reacheables.end();
+  exits_type exits;
 
-  return sub_build(alleles, states, begin, end, begin->second, itr_b, itr_e);
+  exits.reserve(m_data.size());
+
+  for (auto const& a: m_data) {
+
+    exits.push_back(&a.first.reacheable(cache));
+
+  }
+
+  walk(exits, visit);
 
 }
 
 
-::std::vector<ExitAFSPair>
-AFS::sub_build(::std::vector<Allele> alleles,
-               ::std::vector<Index> states,
-               data_type::const_iterator begin,
-               data_type::const_iterator end,
-               Index count,
-               ::std::vector<ExitAllelePair>::const_iterator allele_begin,
-               ::std::vector<ExitAllelePair>::const_iterator allele_end) const {
+void AFS::walk(exits_type const& exits, visitor_type const& visit) const {
 
-  if (count == 0 || allele_begin == allele_end) {
+  ::std::vector<Allele> alleles;
 
-    auto begin_copy = begin;
+  Index count = 0;
 
-    ++begin_copy;
+  for (auto const& a: m_data) {
 
-    return build(alleles, states, begin_copy, end);
+    count += a.second;
 
   }
 
-  using ::std::vector;
+  alleles.reserve(unsign(count));
 
-  vector<ExitAFSPair> retval;
+  StateVector states(unsign(deme() * deme()));
 
-  for (auto a_itr = allele_begin; a_itr != allele_end; ++a_itr) {
+  // All states share the space of the current initial condition.
+  auto space = ::std::make_shared<StateSpace const>(Init(*this));
 
-    auto a_copy = alleles;
-    auto s_copy = states;
+  walk(space, exits, alleles, states, m_data.begin(), visit);
 
-    a_copy.push_back(a_itr->allele);
+}
 
-    auto s = a_itr->state;
-    for (decltype(s.size()) i = 0; i != s.size(); ++i) {
 
-      s_copy[i] += s[i];
+void AFS::walk(::std::shared_ptr<StateSpace const> const& space,
+               exits_type const& exits,
+               ::std::vector<Allele>& alleles,
+               StateVector& states,
+               data_type::const_iterator begin,
+               visitor_type const& visit) const {
 
-    }
+  if (begin == m_data.end()) {
 
-    auto p = sub_build(a_copy, s_copy, begin, end, count - 1, a_itr, allele_end);
+    visit(AFS(alleles), State(space, states));
 
-    retval.insert(retval.end(), p.begin(), p.end());
+    return;
 
   }
 
-  return retval;
+  auto const& reacheables = *exits[unsign(begin - m_data.begin())];
+
+  sub_walk(space, exits, alleles, states, begin, begin->second,
+           reacheables.begin(), reacheables.end(), visit);
 
 }
 
 
-AFS::iterator AFS::begin() {
+void AFS::sub_walk(::std::shared_ptr<StateSpace const> const& space,
+                   exits_type const& exits,
+                   ::std::vector<Allele>& alleles,
+                   StateVector& states,
+                   data_type::const_iterator begin,
+                   Index count,
+                   ::std::vector<ExitAllelePair>::const_iterator allele_begin,
+                   ::std::vector<ExitAllelePair>::const_iterator allele_end,
+                   visitor_type const& visit) const {
 
-  return m_data.begin();
+  if (count == 0 || allele_begin == allele_end) {
 
-}
+    walk(space, exits, alleles, states, ::std::next(begin), visit);
 
+    return;
 
-AFS::const_iterator AFS::begin() const {
+  }
 
-  return m_data.begin();
+  for (auto a_itr = allele_begin; a_itr != allele_end; ++a_itr) {
+
+    auto const& s = a_itr->state;
+
+    alleles.push_back(a_itr->allele);
+
+    for (decltype(s.size()) i = 0; i != s.size(); ++i) {
+
+      states[i] += s[i];
+
+    }
+
+    sub_walk(space, exits, alleles, states, begin, count - 1, a_itr, allele_end, visit);
+
+    for (decltype(s.size()) i = 0; i != s.size(); ++i) {
+
+      states[i] -= s[i];
+
+    }
+
+    alleles.pop_back();
+
+  }
 
 }
 
 
-AFS::iterator AFS::end() {
+AFS::const_iterator AFS::begin() const {
 
-  return m_data.end();
+  return m_data.begin();
 
 }
 
@@ -262,7 +421,7 @@ AFS::const_iterator AFS::end() const {
 
 bool operator==(AFS const& a, AFS const& b) {
 
-  return a.m_data == b.m_data;
+  return a.m_hash == b.m_hash && a.m_data == b.m_data;
 
 }
 
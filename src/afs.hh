@@ -28,10 +28,13 @@
 
 #include <cstddef>
 #include <functional>
-#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 
 #include "typedef.hh"
 #include "allele.hh"
+#include "inline_vector.hh"
 #include "state.hh"
 #include "util.hh"
 
@@ -42,6 +45,8 @@ namespace esf {
 
 class Init;
 
+class ScratchAFS;
+
 // Internally used structs for bookkeeping purpose
 struct ExitAllelePair;
 
@@ -52,49 +57,95 @@ struct ExitAFSPair;
 // (AFS).  It provides convenient access to underlying allele as well
 // as creation of new AFS by modifying the current AFS.  This object
 // is immutable.
+//
+// Alleles and their multiplicities are kept in a contiguous array
+// sorted by alleles, so that copying an AFS copies a single block of
+// memory.  Sizes and the hash are computed once at construction, and
+// equality is rejected early by comparing hashes.
 class AFS {
 
- private:
+ public:
 
-  typedef typename ::std::map<Allele, Index> data_type;
+  typedef Allele key_type;
 
- public:
+  typedef Index mapped_type;
 
-  typedef typename data_type::key_type key_type;
+  typedef ::std::pair<Allele, Index> value_type;
 
-  typedef typename data_type::mapped_type mapped_type;
+  // The pair of the number of genes and the number of singleton
+  // alleles.
+  typedef ::std::pair<Index, Index> layer_type;
 
-  typedef typename data_type::value_type value_type;
+ private:
 
-  typedef typename data_type::iterator iterator;
+  typedef ::std::vector<value_type> data_type;
 
-  typedef typename data_type::const_iterator const_iterator;
+ public:
+
+  // Alleles are read only, since sizes and the hash are kept along
+  // with them.
+  typedef data_type::const_iterator iterator;
+
+  typedef data_type::const_iterator const_iterator;
 
  private:
 
   data_type m_data;
 
-  ::std::vector<ExitAFSPair> build(::std::vector<Allele>,
-                                   ::std::vector<Index>,
-                                   data_type::const_iterator,
-                                   data_type::const_iterator) const;
+  Index m_size;
+
+  DemeVector m_sizes;
+
+  ::std::size_t m_hash;
+
+  // Sorted alleles with positive multiplicities and the number of
+  // demes, which is kept even if no allele remains.
+  AFS(data_type const&, Index);
+
+  // Recomputes sizes and the hash from alleles.
+  void set_summary();
+
+  // Returns the share of an allele and its multiplicity in the hash.
+  // The hash of AFS is the number of demes mixed plus the sum of
+  // shares, so that it can be updated one allele at a time.
+  static ::std::size_t entry_hash(value_type const&);
+
+  const_iterator find(Allele const&) const;
+
+  typedef ::std::function<void(AFS const&, State const&)> visitor_type;
+
+  // Exits of each allele in the order of alleles.
+  typedef ::std::vector<::std::vector<ExitAllelePair> const*> exits_type;
+
+  // Visits all combinations of exits of alleles.
+  void walk(exits_type const&, visitor_type const&) const;
+
+  // Walks combinations of exits of alleles depth first.  Alleles and
+  // states placed so far are kept in scratch buffers, which are
+  // restored on return.
+  void walk(::std::shared_ptr<StateSpace const> const&,
+            exits_type const&,
+            ::std::vector<Allele>&,
+            StateVector&,
+            data_type::const_iterator,
+            visitor_type const&) const;
 
-  ::std::vector<ExitAFSPair> sub_build(::std::vector<Allele>,
-                                       ::std::vector<Index>,
-                                       data_type::const_iterator,
-                                       data_type::const_iterator,
-                                       Index,
-                                       ::std::vector<ExitAllelePair>::const_iterator,
-                                       ::std::vector<ExitAllelePair>::const_iterator) const;
+  void sub_walk(::std::shared_ptr<StateSpace const> const&,
+                exits_type const&,
+                ::std::vector<Allele>&,
+                StateVector&,
+                data_type::const_iterator,
+                Index,
+                ::std::vector<ExitAllelePair>::const_iterator,
+                ::std::vector<ExitAllelePair>::const_iterator,
+                visitor_type const&) const;
 
  public:
 
-  AFS() = default;
+  AFS();
 
   AFS(::std::vector<Allele> const&);
 
-  AFS(data_type const&);
-
   AFS(AFS const&) = default;
 
   AFS& operator=(AFS const&) = default;
@@ -126,17 +177,29 @@ class AFS {
   // Returns the number of demes.
   Index deme() const;
 
+  // Returns the layer of AFS.  An AFS depends only on AFS in lower
+  // layers, as every step of the recursion either removes a gene or
+  // turns a singleton allele into a non-singleton one.
+  layer_type layer() const;
+
+  // Returns the hash of AFS.  It is the same for equal AFS.
+  ::std::size_t hash() const;
+
   // Returns a list of AFS reacheable by one or more migrations.
   // Because origin and destination of genes need to be tracked,
   // return value is a list of pairs, whose first element is AFS and
   // the second element is its corresponding states.
   ::std::vector<ExitAFSPair> reacheable() const;
 
-  iterator begin();
+  // Calls visit(afs, state) for each pair of reacheable(), in the same
+  // order, without keeping them.  Both arguments are valid only during
+  // the call.
+  void reacheable(visitor_type const& visit) const;
 
-  const_iterator begin() const;
+  // The same as above, but alleles are expanded through the cache.
+  void reacheable(visitor_type const& visit, AlleleExitCache&) const;
 
-  iterator end();
+  const_iterator begin() const;
 
   const_iterator end() const;
 
@@ -146,6 +209,8 @@ class AFS {
 
   friend bool operator<(AFS const&, AFS const&);
 
+  friend class ScratchAFS;
+
 };
 
 
@@ -178,32 +243,7 @@ struct hash<::esf::AFS> {
 
   ::std::size_t operator()(::esf::AFS const& afs) const {
 
-    using ::std::size_t;
-    using ::esf::unsign;
-
-    ::std::hash<size_t> hasher;
-
-    size_t mult = (1 << 4) - 1, hash = 1;
-
-    for (auto elem: afs) {
-
-      size_t deme = 1, i = unsign(elem.second), value = 1;
-
-      for (auto d: elem.first) {
-
-        value += deme * unsign(d) * i;
-
-        deme <<= 1;
-
-      }
-
-      hash *= hasher(mult * value);
-
-      mult <<= 1;
-
-    }
-
-    return hash;
+    return afs.hash();
 
   }
 
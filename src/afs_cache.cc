@@ -0,0 +1,106 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// afs_cache.cc - Cache of values indexed by interned AFS
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstddef>
+
+#include "afs.hh"
+#include "afs_cache.hh"
+#include "afs_table.hh"
+#include "cache.hh"
+#include "hash.hh"
+
+namespace esf {
+
+
+AFSCache::AFSCache(AFS const& root)
+    : m_table(), m_values(), m_computed(), m_root(root),
+      m_hits(0), m_misses(0), m_inserts(0) {}
+
+
+AFS const& AFSCache::root() const {
+
+  return m_root;
+
+}
+
+
+AFSTable const& AFSCache::table() const {
+
+  return m_table;
+
+}
+
+
+AFSCache::id_type AFSCache::intern(AFS const& afs) {
+
+  auto id = m_table.intern(afs);
+
+  if (m_values.size() <= id) {
+
+    m_values.resize(m_table.size());
+    m_computed.resize(m_table.size(), false);
+
+  }
+
+  return id;
+
+}
+
+
+double const* AFSCache::find(AFS const& afs) const {
+
+  auto id = m_table.find(afs);
+
+  if (id == AFSTable::npos || !m_computed[id]) {
+
+    ++m_misses;
+
+    return nullptr;
+
+  }
+
+  ++m_hits;
+
+  return &m_values[id];
+
+}
+
+
+CacheStats AFSCache::stats() const {
+
+  return {m_hits, m_misses, m_inserts, m_inserts, m_table.slots(),
+          static_cast<double>(m_table.size()) / m_table.slots(), 0};
+
+}
+
+
+HashDiagnostics AFSCache::diagnostics() const {
+
+  return m_table.diagnostics();
+
+}
+
+
+}
@@ -0,0 +1,173 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// afs_cache.hh - Cache of values indexed by interned AFS
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_AFS_CACHE_HH
+#define ESF_MULTI_AFS_CACHE_HH
+
+#include <cstddef>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "cache.hh"
+#include "hash.hh"
+#include "scratch_afs.hh"
+
+namespace esf {
+
+
+// This class caches a probability of each AFS.  AFS are interned by
+// AFSTable, and values are kept in a plain array indexed by their IDs.
+// A separate bit for each ID tells whether the value has been computed,
+// so any double, including NaN, can be cached.
+class AFSCache {
+
+ public:
+
+  typedef AFSTable::id_type id_type;
+
+ private:
+
+  AFSTable m_table;
+
+  ::std::vector<double> m_values;
+
+  ::std::vector<bool> m_computed;
+
+  AFS const& m_root;
+
+  mutable ::std::size_t m_hits;
+
+  mutable ::std::size_t m_misses;
+
+  ::std::size_t m_inserts;
+
+ public:
+
+  AFSCache(AFS const&);
+
+  AFS const& root() const;
+
+  AFSTable const& table() const;
+
+  // Returns the ID of the AFS, and assigns a new ID if it has not
+  // been interned.
+  id_type intern(AFS const&);
+
+  // Returns a pointer to the cached value, or nullptr if the value
+  // has not been computed.  Lookups are counted as hits or misses.
+  double const* find(AFS const&) const;
+
+  // Returns the cached value of an AFS.  On a miss, the value is
+  // computed by calling fn() and stored.  fn() may use the cache
+  // recursively.
+  template <typename FN>
+  double get_or_compute(AFS const&, FN);
+
+  // The same as above for AFS being modified in place.  On a miss, the
+  // AFS is interned, and fn(AFS const&) is called with the interned
+  // copy.
+  template <typename FN>
+  double get_or_compute(ScratchAFS const&, FN);
+
+  CacheStats stats() const;
+
+  // Returns how interned AFS are spread over slots.
+  HashDiagnostics diagnostics() const;
+
+};
+
+
+// template function definitions
+
+template <typename FN>
+double AFSCache::get_or_compute(AFS const& afs, FN fn) {
+
+  auto id = intern(afs);
+
+  if (m_computed[id]) {
+
+    ++m_hits;
+
+    return m_values[id];
+
+  }
+
+  ++m_misses;
+
+  // fn() may intern more AFS and move the values.
+  double value = fn();
+
+  m_values[id] = value;
+  m_computed[id] = true;
+
+  ++m_inserts;
+
+  return value;
+
+}
+
+
+template <typename FN>
+double AFSCache::get_or_compute(ScratchAFS const& afs, FN fn) {
+
+  auto id = m_table.find(afs);
+
+  if (id != AFSTable::npos && m_computed[id]) {
+
+    ++m_hits;
+
+    return m_values[id];
+
+  }
+
+  ++m_misses;
+
+  if (id == AFSTable::npos) {
+
+    id = m_table.intern(afs);
+
+    m_values.resize(m_table.size());
+    m_computed.resize(m_table.size(), false);
+
+  }
+
+  // Interned AFS stay in place while fn() interns more.
+  double value = fn(m_table[id]);
+
+  m_values[id] = value;
+  m_computed[id] = true;
+
+  ++m_inserts;
+
+  return value;
+
+}
+
+
+}
+
+
+#endif // ESF_MULTI_AFS_CACHE_HH
@@ -0,0 +1,225 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// afs_table.cc - Interning of allele frequency spectra
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <stdexcept>
+#include <unordered_set>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "hash.hh"
+#include "scratch_afs.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+constexpr AFSTable::id_type AFSTable::npos;
+
+
+AFSTable::AFSTable()
+    : m_afs(), m_slots(16, npos) {}
+
+
+template <typename KEY>
+::std::size_t AFSTable::slot(KEY const& key) const {
+
+  auto mask = m_slots.size() - 1;
+
+  auto pos = key.hash() & mask;
+
+  // Hashes are compared first by operator==.
+  while (m_slots[pos] != npos && !(m_afs[m_slots[pos]] == key)) {
+
+    pos = (pos + 1) & mask;
+
+  }
+
+  return pos;
+
+}
+
+
+void AFSTable::grow() {
+
+  ::std::vector<id_type> slots(m_slots.size() * 2, npos);
+
+  m_slots.swap(slots);
+
+  auto mask = m_slots.size() - 1;
+
+  for (id_type id = 0; id < m_afs.size(); ++id) {
+
+    auto pos = m_afs[id].hash() & mask;
+
+    while (m_slots[pos] != npos) {
+
+      pos = (pos + 1) & mask;
+
+    }
+
+    m_slots[pos] = id;
+
+  }
+
+}
+
+
+AFSTable::id_type AFSTable::insert(::std::size_t pos, AFS const& afs) {
+
+  if (m_afs.size() >= npos) {
+
+    throw ::std::overflow_error("too many AFS to intern");
+
+  }
+
+  auto id = static_cast<id_type>(m_afs.size());
+
+  m_afs.push_back(afs);
+
+  // At most a half of slots are occupied.
+  if (m_afs.size() * 2 > m_slots.size()) {
+
+    grow();
+
+  } else {
+
+    m_slots[pos] = id;
+
+  }
+
+  return id;
+
+}
+
+
+AFSTable::id_type AFSTable::intern(AFS const& afs) {
+
+  auto pos = slot(afs);
+
+  return m_slots[pos] != npos ? m_slots[pos] : insert(pos, afs);
+
+}
+
+
+AFSTable::id_type AFSTable::find(AFS const& afs) const {
+
+  return m_slots[slot(afs)];
+
+}
+
+
+AFSTable::id_type AFSTable::intern(ScratchAFS const& afs) {
+
+  auto pos = slot(afs);
+
+  return m_slots[pos] != npos ? m_slots[pos] : insert(pos, afs.afs());
+
+}
+
+
+AFSTable::id_type AFSTable::find(ScratchAFS const& afs) const {
+
+  return m_slots[slot(afs)];
+
+}
+
+
+HashDiagnostics AFSTable::diagnostics() const {
+
+  using ::std::size_t;
+
+  HashDiagnostics diag;
+
+  diag.keys = m_afs.size();
+  diag.buckets = m_slots.size();
+  diag.bucket_lengths.assign(1, 0);
+
+  auto mask = m_slots.size() - 1;
+
+  size_t displaced = 0, probes = 0;
+
+  for (size_t pos = 0; pos < m_slots.size(); ++pos) {
+
+    if (m_slots[pos] == npos) {
+
+      ++diag.bucket_lengths[0];
+
+      continue;
+
+    }
+
+    // A key is found after visiting slots from its home slot.
+    auto home = m_afs[m_slots[pos]].hash() & mask;
+    auto distance = (pos - home) & mask;
+
+    displaced += distance > 0 ? 1 : 0;
+    probes += distance + 1;
+
+    // Runs are counted at their last slot, and a run wrapping around
+    // the end is counted once at its last slot from the beginning.
+    auto next = (pos + 1) & mask;
+
+    if (m_slots[next] == npos) {
+
+      size_t len = 0;
+
+      for (auto p = pos; m_slots[p] != npos; p = (p - 1) & mask) {
+
+        ++len;
+
+      }
+
+      if (diag.bucket_lengths.size() <= len) {
+
+        diag.bucket_lengths.resize(len + 1, 0);
+
+      }
+
+      ++diag.bucket_lengths[len];
+
+    }
+
+  }
+
+  ::std::unordered_set<size_t> hashes;
+
+  for (auto const& afs: m_afs) {
+
+    hashes.insert(afs.hash());
+
+  }
+
+  auto keys = static_cast<double>(::std::max<size_t>(1, diag.keys));
+
+  diag.bucket_collision_rate = displaced / keys;
+  diag.hash_collision_rate = (diag.keys - hashes.size()) / keys;
+  diag.mean_probe = probes / keys;
+
+  return diag;
+
+}
+
+
+}
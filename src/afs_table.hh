@@ -0,0 +1,110 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// afs_table.hh - Interning of allele frequency spectra
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_AFS_TABLE_HH
+#define ESF_MULTI_AFS_TABLE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "afs.hh"
+#include "hash.hh"
+#include "scratch_afs.hh"
+
+namespace esf {
+
+
+// This class assigns a dense integer ID to each distinct AFS.  IDs
+// are given in the order AFS are first seen, starting from zero, so
+// that values associated with AFS can be kept in a plain array indexed
+// by ID, and two interned AFS are equal if and only if their IDs are.
+//
+// Each distinct AFS is kept as a full copy in a deque, so that it stays
+// in place as more are interned.  Lookup goes through an open
+// addressing table of IDs with linear probing, and it compares cached
+// hashes before comparing spectra.
+class AFSTable {
+
+ public:
+
+  typedef ::std::uint32_t id_type;
+
+  // Returned by find() for AFS which has not been interned.
+  static constexpr id_type npos = static_cast<id_type>(-1);
+
+ private:
+
+  ::std::deque<AFS> m_afs;
+
+  // IDs, or npos for an empty slot.  The size is a power of two.
+  ::std::vector<id_type> m_slots;
+
+  template <typename KEY>
+  ::std::size_t slot(KEY const&) const;
+
+  // Assigns a new ID to the AFS at an empty slot.
+  id_type insert(::std::size_t, AFS const&);
+
+  void grow();
+
+ public:
+
+  AFSTable();
+
+  // Returns the ID of the AFS, and assigns a new ID if it has not
+  // been interned.  Throws std::overflow_error if IDs run out.
+  id_type intern(AFS const&);
+
+  // Returns the ID of the AFS, or npos if it has not been interned.
+  id_type find(AFS const&) const;
+
+  // The same as above for AFS being modified in place.  A persistent
+  // copy is made only when a new ID is assigned.
+  id_type intern(ScratchAFS const&);
+
+  id_type find(ScratchAFS const&) const;
+
+  // Returns the AFS with the ID.  The reference stays valid when
+  // more AFS are interned.
+  AFS const& operator[](id_type id) const { return m_afs[id]; }
+
+  ::std::size_t size() const { return m_afs.size(); }
+
+  ::std::size_t slots() const { return m_slots.size(); }
+
+  // Returns how IDs are spread over slots.  A bucket is a run of
+  // occupied slots, and a key collides when it is not in the slot its
+  // hash points at.
+  HashDiagnostics diagnostics() const;
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_AFS_TABLE_HH
@@ -30,6 +30,7 @@
 #include <utility>
 
 #include "allele.hh"
+#include "concurrent_cache.hh"
 #include "util.hh"
 
 namespace esf {
@@ -44,7 +45,7 @@ using ::std::vector;
 vector<Allele> move_genes(Allele const&, Index, Index);
 
 vector<ExitAllelePair> combine(Allele const&,
-                               vector<Index> const&,
+                               StateVector const&,
                                vector<vector<Allele>>::iterator,
                                vector<vector<Allele>>::iterator);
 
@@ -56,6 +57,10 @@ Allele::Allele(::std::vector<Index> const& d)
       m_total(::std::accumulate(d.begin(), d.end(), static_cast<Index>(0))) {}
 
 
+Allele::Allele(value_type const& d, Index total)
+    : m_data(d), m_total(total) {}
+
+
 Index Allele::size() const {
 
   return m_total;
@@ -76,7 +81,7 @@ Allele Allele::remove(Index deme) const {
 
   --data[unsign(deme)];
 
-  return Allele(data);
+  return Allele(data, m_total - 1);
 
 }
 
@@ -87,7 +92,7 @@ Allele Allele::add(Index deme) const {
 
   ++data[unsign(deme)];
 
-  return Allele(data);
+  return Allele(data, m_total + 1);
 
 }
 
@@ -99,15 +104,20 @@ bool Allele::singleton() const {
 }
 
 
+::std::vector<ExitAllelePair> const& Allele::reacheable(AlleleExitCache& cache) const {
+
+  return cache.get_or_compute(*this, [this]() { return reacheable(); });
+
+}
+
+
 ::std::vector<ExitAllelePair> Allele::reacheable() const {
 
   using ::std::vector;
 
   auto d = deme();
 
-  vector<Index> vals(unsign(d));
-
-  Allele base(vals);
+  Allele base(value_type(unsign(d)), 0);
 
   vector<vector<Allele>> retvals;
 
@@ -121,7 +131,8 @@ bool Allele::singleton() const {
 
   for (auto a: retvals[0]) {
 
-    auto pairs = combine(a, a.m_data, retvals.begin() + 1, retvals.end());
+    auto pairs = combine(a, StateVector(a.begin(), a.end()),
+                         retvals.begin() + 1, retvals.end());
 
     data.insert(data.end(), pairs.begin(), pairs.end());
 
@@ -132,13 +143,6 @@ bool Allele::singleton() const {
 }
 
 
-Allele::iterator Allele::begin() {
-
-  return m_data.begin();
-
-}
-
-
 Allele::const_iterator Allele::begin() const {
 
   return m_data.begin();
@@ -146,13 +150,6 @@ Allele::const_iterator Allele::begin() const {
 }
 
 
-Allele::iterator Allele::end() {
-
-  return m_data.end();
-
-}
-
-
 Allele::const_iterator Allele::end() const {
 
   return m_data.end();
@@ -167,13 +164,6 @@ bool Allele::operator<(Allele const& allele) const {
 }
 
 
-Index& Allele::operator[](Index deme) {
-
-  return m_data[unsign(deme)];
-
-}
-
-
 Index Allele::operator[](Index deme) const {
 
   return m_data[unsign(deme)];
@@ -241,7 +231,7 @@ namespace {
 
 
 vector<ExitAllelePair> combine(Allele const& allele,
-                               vector<Index> const& state,
+                               StateVector const& state,
                                vector<vector<Allele>>::iterator begin,
                                vector<vector<Allele>>::iterator end) {
 
@@ -257,7 +247,11 @@ vector<ExitAllelePair> combine(Allele const& allele,
 
     auto s = state;
 
-    s.insert(s.end(), a.begin(), a.end());
+    for (auto n: a) {
+
+      s.push_back(n);
+
+    }
 
     auto b = allele;
 
@@ -26,9 +26,15 @@
 #ifndef ESF_MULTI_ALLELE_HH
 #define ESF_MULTI_ALLELE_HH
 
+#include <cstddef>
+#include <functional>
 #include <vector>
 
+#include "concurrent_cache.hh"
+#include "hash.hh"
+#include "inline_vector.hh"
 #include "typedef.hh"
+#include "util.hh"
 
 namespace esf {
 
@@ -38,6 +44,14 @@ namespace esf {
 // Internally used struct for bookkeeping allele and its corresponding state.
 struct ExitAllelePair;
 
+class Allele;
+
+// Alleles reacheable from each allele.  A cache is kept by the caller
+// exploring samples, and it is passed to Allele::reacheable() and
+// AFS::reacheable(), so that an allele shared by many samples is
+// expanded only once.
+typedef ConcurrentCache<Allele, ::std::vector<ExitAllelePair>> AlleleExitCache;
+
 
 // This class represents an allele, a collection of genes with an
 // identical genotype, and it keeps track of the number of genes
@@ -46,11 +60,12 @@ class Allele {
 
  private:
 
-  typedef ::std::vector<Index> value_type;
+  typedef DemeVector value_type;
 
  public:
 
-  typedef value_type::iterator iterator;
+  // Counts are read only, since the total is kept along with them.
+  typedef value_type::const_iterator iterator;
 
   typedef value_type::const_iterator const_iterator;
 
@@ -62,6 +77,8 @@ class Allele {
 
   Index m_deme;
 
+  Allele(value_type const&, Index);
+
  public:
 
   // This constructor is designed to be invoked with data, which is
@@ -100,13 +117,14 @@ class Allele {
   // migrations where the source and target demes are the same.
   ::std::vector<ExitAllelePair> reacheable() const;
 
-  // Exposes the iterator of underlying container.
-  iterator begin();
+  // The same as above, but the list is built once per distinct allele
+  // and kept in the cache.  The returned reference stays valid until
+  // the cache is cleared.  It is safe to call from multiple threads.
+  ::std::vector<ExitAllelePair> const& reacheable(AlleleExitCache&) const;
 
+  // Exposes the iterator of underlying container.
   const_iterator begin() const;
 
-  iterator end();
-
   const_iterator end() const;
 
   // Implements less-than operator for establishing strict weak
@@ -115,8 +133,6 @@ class Allele {
   bool operator<(Allele const&) const;
 
   // Returns number of genes in a specified deme.
-  Index& operator[](Index);
-
   Index operator[](Index) const;
 
   // Implements equality test for the same reason as less-than operator.
@@ -133,7 +149,7 @@ struct ExitAllelePair {
 
   Allele allele;
 
-  ::std::vector<Index> state;
+  StateVector state;
 
 };
 
@@ -145,4 +161,32 @@ std::ostream& operator<<(std::ostream&, Allele const&);
 }
 
 
+namespace std {
+
+
+template <>
+struct hash<::esf::Allele> {
+
+  ::std::size_t operator()(::esf::Allele const& allele) const {
+
+    using ::esf::unsign;
+
+    auto hash = ::esf::hash_mix(unsign(allele.deme()));
+
+    for (auto i: allele) {
+
+      hash = ::esf::hash_combine(hash, unsign(i));
+
+    }
+
+    return static_cast<::std::size_t>(hash);
+
+  }
+
+};
+
+
+}
+
+
 #endif // ESF_MULTI_ALLELE_HH
@@ -0,0 +1,85 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// array_view.hh - Read-only view of a contiguous array
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_ARRAY_VIEW_HH
+#define ESF_MULTI_ARRAY_VIEW_HH
+
+#include <cstddef>
+#include <vector>
+
+namespace esf {
+
+
+// This class refers to a contiguous array owned by someone else, such
+// as a vector or a mapped file.  It provides the read-only part of the
+// interface of ::std::vector.
+template <typename T>
+class ArrayView {
+
+ public:
+
+  typedef T value_type;
+
+  typedef T const* const_iterator;
+
+  typedef ::std::size_t size_type;
+
+ private:
+
+  T const* m_data;
+
+  size_type m_size;
+
+ public:
+
+  ArrayView() : m_data(nullptr), m_size(0) {}
+
+  ArrayView(T const* data, size_type size) : m_data(data), m_size(size) {}
+
+  ArrayView(::std::vector<T> const& v) : m_data(v.data()), m_size(v.size()) {}
+
+  T const* data() const { return m_data; }
+
+  size_type size() const { return m_size; }
+
+  bool empty() const { return m_size == 0; }
+
+  T const& operator[](size_type i) const { return m_data[i]; }
+
+  T const& front() const { return m_data[0]; }
+
+  T const& back() const { return m_data[m_size - 1]; }
+
+  const_iterator begin() const { return m_data; }
+
+  const_iterator end() const { return m_data + m_size; }
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_ARRAY_VIEW_HH
@@ -0,0 +1,92 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// binomial.cc - Tables of binomial coefficients
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "binomial.hh"
+#include "typedef.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+BinomialTable::BinomialTable(Index deme, Index genes)
+    : m_deme(deme), m_genes(genes),
+      m_table(unsign(deme * (genes + 1))) {
+
+  auto width = genes + 1;
+
+  for (decltype(deme) a = 0; a < deme; ++a) {
+
+    for (decltype(genes) k = 0; k <= genes; ++k) {
+
+      auto& entry = m_table[unsign(a * width + k)];
+
+      if (a + k < small_binomial_size) {
+
+        entry = small_binomial(a + k, k);
+
+        continue;
+
+      }
+
+      if (a == 0 || k == 0) {
+
+        entry = 1;
+
+        continue;
+
+      }
+
+      // Pascal's rule.
+      auto up = m_table[unsign((a - 1) * width + k)];
+
+      auto left = m_table[unsign(a * width + k - 1)];
+
+      if (up > ::std::numeric_limits<Index>::max() - left) {
+
+        throw ::std::overflow_error("binomial coefficient does not fit in Index");
+
+      }
+
+      entry = up + left;
+
+    }
+
+  }
+
+}
+
+
+Index BinomialTable::compute(Index n, Index k) const {
+
+  return binomial(n, k);
+
+}
+
+
+}
@@ -0,0 +1,190 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// binomial.hh - Tables of binomial coefficients
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_BINOMIAL_HH
+#define ESF_MULTI_BINOMIAL_HH
+
+#include <vector>
+
+#include "typedef.hh"
+
+namespace esf {
+
+
+// Binomial coefficients of arguments below this bound are tabulated
+// at compile time.  All of them fit in a 32 bit signed integer.
+constexpr Index small_binomial_size = 34;
+
+
+// Sequence of indices generated at compile time.  C++11 lacks
+// ::std::index_sequence, and this one is built by doubling so that the
+// depth of template recursion is logarithmic in its length.
+template <Index...>
+struct IndexSequence {};
+
+
+template <class, class>
+struct ConcatIndexSequence;
+
+
+template <Index... I, Index... J>
+struct ConcatIndexSequence<IndexSequence<I...>, IndexSequence<J...>> {
+
+  typedef IndexSequence<I..., (sizeof...(I) + J)...> type;
+
+};
+
+
+template <Index N>
+struct MakeIndexSequence {
+
+  typedef typename ConcatIndexSequence<
+    typename MakeIndexSequence<N / 2>::type,
+    typename MakeIndexSequence<N - N / 2>::type>::type type;
+
+};
+
+
+template <>
+struct MakeIndexSequence<0> {
+
+  typedef IndexSequence<> type;
+
+};
+
+
+template <>
+struct MakeIndexSequence<1> {
+
+  typedef IndexSequence<0> type;
+
+};
+
+
+// C(n, k) = C(n, k - 1) * (n - k + 1) / k, where the division is exact.
+constexpr Index binomial_product(Index n, Index k) {
+
+  return k == 0 ? 1 : binomial_product(n, k - 1) * (n - k + 1) / k;
+
+}
+
+
+// Entry of a square table of binomial coefficients in row major order.
+constexpr Index small_binomial_entry(Index i) {
+
+  return i % small_binomial_size > i / small_binomial_size
+    ? 0
+    : binomial_product(i / small_binomial_size, i % small_binomial_size);
+
+}
+
+
+template <class>
+struct SmallBinomialTable;
+
+
+template <Index... I>
+struct SmallBinomialTable<IndexSequence<I...>> {
+
+  static constexpr Index value[sizeof...(I)] = {small_binomial_entry(I)...};
+
+};
+
+
+template <Index... I>
+constexpr Index SmallBinomialTable<IndexSequence<I...>>::value[sizeof...(I)];
+
+
+typedef SmallBinomialTable<
+  MakeIndexSequence<small_binomial_size * small_binomial_size>::type
+  > SmallBinomial;
+
+
+// Returns a binomial coefficient from the compile time table.  Both
+// arguments must be smaller than small_binomial_size.
+constexpr Index small_binomial(Index n, Index k) {
+
+  return k < 0 || k > n ? 0 : SmallBinomial::value[n * small_binomial_size + k];
+
+}
+
+
+// This class tabulates binomial coefficients used to rank compositions
+// of at most a given number of genes over a given number of demes.
+//
+// Such a coefficient is C(a + k, k) with a smaller than the number of
+// demes and k not greater than the number of genes, and the table is
+// the corresponding rectangle of Pascal's triangle.  The largest entry
+// is the number of compositions of all genes, and construction throws
+// ::std::overflow_error if it does not fit in Index.
+class BinomialTable {
+
+ private:
+
+  Index m_deme;
+
+  Index m_genes;
+
+  // C(a + k, k) at a * (m_genes + 1) + k.
+  ::std::vector<Index> m_table;
+
+  Index compute(Index, Index) const;
+
+ public:
+
+  BinomialTable(Index deme, Index genes);
+
+  // Returns C(n, k).  Arguments outside of the table are computed on
+  // demand.
+  Index operator()(Index n, Index k) const;
+
+};
+
+
+inline Index BinomialTable::operator()(Index n, Index k) const {
+
+  if (k < 0 || k > n) {
+
+    return 0;
+
+  }
+
+  auto a = n - k;
+
+  if (a < m_deme && k <= m_genes) {
+
+    return m_table[static_cast<size_t>(a * (m_genes + 1) + k)];
+
+  }
+
+  return compute(n, k);
+
+}
+
+
+}
+
+
+#endif // ESF_MULTI_BINOMIAL_HH
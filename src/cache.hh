@@ -26,12 +26,37 @@
 #ifndef ESF_MULTI_CACHE_HH
 #define ESF_MULTI_CACHE_HH
 
+#include <cstddef>
 #include <unordered_map>
+#include <utility>
+
+#include "hash.hh"
 
 
 namespace esf {
 
 
+// Counters describing how effective a cache is.
+struct CacheStats {
+
+  ::std::size_t hits;
+
+  ::std::size_t misses;
+
+  ::std::size_t inserts;
+
+  ::std::size_t size;
+
+  ::std::size_t buckets;
+
+  double load_factor;
+
+  // Lookups which waited for a value computed by another thread.
+  ::std::size_t waits;
+
+};
+
+
 template <typename KEY, typename VALUE>
 class Cache {
 
@@ -46,6 +71,12 @@ class Cache {
 
   KEY const& m_root;
 
+  mutable ::std::size_t m_hits;
+
+  mutable ::std::size_t m_misses;
+
+  ::std::size_t m_inserts;
+
  public:
 
   Cache(KEY const&);
@@ -58,12 +89,34 @@ class Cache {
   VALUE& operator[](KEY const&);
   VALUE operator[](KEY const&) const;
 
+  // Returns a pointer to the cached value, or nullptr if the key is
+  // absent.  Lookups are counted as hits or misses.
+  VALUE* find(KEY const&);
+  VALUE const* find(KEY const&) const;
+
+  // Inserts a value unless the key is already present.  Returns the
+  // cached value and whether it was inserted.
+  ::std::pair<VALUE*, bool> try_emplace(KEY const&, VALUE const&);
+
+  // Returns the cached value of a key.  On a miss, the value is
+  // computed by calling fn() and stored.  A hit probes the table once
+  // and a miss once more to insert, and nothing is thrown unless fn()
+  // throws.  fn() may use the cache recursively, and references to
+  // values stay valid when the table grows.
+  template <typename FN>
+  VALUE& get_or_compute(KEY const&, FN);
+
+  CacheStats stats() const;
+
+  // Returns how keys are spread over buckets.
+  HashDiagnostics diagnostics() const;
+
 };
 
 
 template <typename KEY, typename VALUE>
 Cache<KEY, VALUE>::Cache(KEY const& root)
-    : m_root(root) {}
+    : m_root(root), m_hits(0), m_misses(0), m_inserts(0) {}
 
 
 template <typename KEY, typename VALUE>
@@ -106,6 +159,109 @@ VALUE Cache<KEY, VALUE>::operator[](KEY const& key) const {
 }
 
 
+template <typename KEY, typename VALUE>
+VALUE* Cache<KEY, VALUE>::find(KEY const& key) {
+
+  auto itr = m_cache.find(key);
+
+  if (itr == m_cache.end()) {
+
+    ++m_misses;
+
+    return nullptr;
+
+  }
+
+  ++m_hits;
+
+  return &itr->second;
+
+}
+
+
+template <typename KEY, typename VALUE>
+VALUE const* Cache<KEY, VALUE>::find(KEY const& key) const {
+
+  auto itr = m_cache.find(key);
+
+  if (itr == m_cache.end()) {
+
+    ++m_misses;
+
+    return nullptr;
+
+  }
+
+  ++m_hits;
+
+  return &itr->second;
+
+}
+
+
+template <typename KEY, typename VALUE>
+::std::pair<VALUE*, bool>
+Cache<KEY, VALUE>::try_emplace(KEY const& key, VALUE const& value) {
+
+  auto result = m_cache.insert({key, value});
+
+  if (result.second) {
+
+    ++m_inserts;
+
+  }
+
+  return {&result.first->second, result.second};
+
+}
+
+
+template <typename KEY, typename VALUE>
+template <typename FN>
+VALUE& Cache<KEY, VALUE>::get_or_compute(KEY const& key, FN fn) {
+
+  auto itr = m_cache.find(key);
+
+  if (itr != m_cache.end()) {
+
+    ++m_hits;
+
+    return itr->second;
+
+  }
+
+  ++m_misses;
+
+  auto result = m_cache.emplace(key, fn());
+
+  if (result.second) {
+
+    ++m_inserts;
+
+  }
+
+  return result.first->second;
+
+}
+
+
+template <typename KEY, typename VALUE>
+CacheStats Cache<KEY, VALUE>::stats() const {
+
+  return {m_hits, m_misses, m_inserts, m_cache.size(),
+          m_cache.bucket_count(), m_cache.load_factor(), 0};
+
+}
+
+
+template <typename KEY, typename VALUE>
+HashDiagnostics Cache<KEY, VALUE>::diagnostics() const {
+
+  return diagnose(m_cache);
+
+}
+
+
 }
 
 
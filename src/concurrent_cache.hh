@@ -0,0 +1,292 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// concurrent_cache.hh - Thread-safe cache sharded by hash
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_CONCURRENT_CACHE_HH
+#define ESF_MULTI_CONCURRENT_CACHE_HH
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "cache.hh"
+
+namespace esf {
+
+
+// This class is a cache shared by threads.
+//
+// Keys are distributed over shards by their hash, and each shard is a
+// table guarded by its own mutex, so threads working on different keys
+// rarely contend.  A value is computed outside of the lock.  While it
+// is computed, the key maps to a future of the value, and other threads
+// asking for the same key wait for it instead of computing it again.
+//
+// Values never move once inserted, and references to them stay valid
+// until the cache is cleared or destroyed.
+template <typename KEY, typename VALUE>
+class ConcurrentCache {
+
+ public:
+
+  typedef KEY key_type;
+  typedef VALUE value_type;
+
+ private:
+
+  typedef ::std::shared_future<VALUE> future_type;
+
+  struct Shard {
+
+    ::std::mutex mutex;
+
+    ::std::unordered_map<KEY, future_type, ::std::hash<KEY>> table;
+
+  };
+
+  ::std::size_t m_size;
+
+  ::std::unique_ptr<Shard[]> m_shards;
+
+  ::std::atomic<::std::size_t> m_hits;
+
+  ::std::atomic<::std::size_t> m_misses;
+
+  ::std::atomic<::std::size_t> m_inserts;
+
+  ::std::atomic<::std::size_t> m_waits;
+
+  Shard& shard(KEY const&) const;
+
+ public:
+
+  // Creates a cache with the specified number of shards.
+  explicit ConcurrentCache(::std::size_t = 64);
+
+  ConcurrentCache(ConcurrentCache const&) = delete;
+
+  ConcurrentCache& operator=(ConcurrentCache const&) = delete;
+
+  ~ConcurrentCache() = default;
+
+  // Returns the number of shards.
+  ::std::size_t shards() const;
+
+  // Returns a pointer to the value of a key, or nullptr if the key is
+  // absent or its value is still being computed.
+  VALUE const* find(KEY const&) const;
+
+  // Returns the value of a key.  On a miss, the value is computed by
+  // calling fn() on this thread and stored.  If another thread is
+  // computing the same key, this waits for its value.  An exception
+  // thrown by fn() is rethrown to every waiting thread, and the key is
+  // left absent.  fn() must not ask for the same key.
+  template <typename FN>
+  VALUE const& get_or_compute(KEY const&, FN);
+
+  // Removes all values.  No other thread may use the cache meanwhile.
+  void clear();
+
+  CacheStats stats() const;
+
+};
+
+
+// template function definitions
+
+template <typename KEY, typename VALUE>
+ConcurrentCache<KEY, VALUE>::ConcurrentCache(::std::size_t shards)
+    : m_size(shards > 0 ? shards : 1),
+      m_shards(new Shard[m_size]),
+      m_hits(0), m_misses(0), m_inserts(0), m_waits(0) {}
+
+
+template <typename KEY, typename VALUE>
+typename ConcurrentCache<KEY, VALUE>::Shard&
+ConcurrentCache<KEY, VALUE>::shard(KEY const& key) const {
+
+  return m_shards[::std::hash<KEY>()(key) % m_size];
+
+}
+
+
+template <typename KEY, typename VALUE>
+::std::size_t ConcurrentCache<KEY, VALUE>::shards() const {
+
+  return m_size;
+
+}
+
+
+template <typename KEY, typename VALUE>
+VALUE const* ConcurrentCache<KEY, VALUE>::find(KEY const& key) const {
+
+  auto& s = shard(key);
+
+  future_type value;
+
+  {
+
+    ::std::lock_guard<::std::mutex> lock(s.mutex);
+
+    auto itr = s.table.find(key);
+
+    if (itr == s.table.end()) {
+
+      return nullptr;
+
+    }
+
+    value = itr->second;
+
+  }
+
+  if (value.wait_for(::std::chrono::seconds(0)) != ::std::future_status::ready) {
+
+    return nullptr;
+
+  }
+
+  return &value.get();
+
+}
+
+
+template <typename KEY, typename VALUE>
+template <typename FN>
+VALUE const& ConcurrentCache<KEY, VALUE>::get_or_compute(KEY const& key, FN fn) {
+
+  auto& s = shard(key);
+
+  ::std::promise<VALUE> promise;
+
+  future_type value;
+
+  bool found;
+
+  {
+
+    ::std::lock_guard<::std::mutex> lock(s.mutex);
+
+    auto itr = s.table.find(key);
+
+    found = itr != s.table.end();
+
+    if (!found) {
+
+      itr = s.table.emplace(key, promise.get_future().share()).first;
+
+    }
+
+    value = itr->second;
+
+  }
+
+  if (found) {
+
+    ++m_hits;
+
+    if (value.wait_for(::std::chrono::seconds(0)) != ::std::future_status::ready) {
+
+      ++m_waits;
+
+    }
+
+    // The table keeps the shared state, and the reference outlives the
+    // local future.
+    return value.get();
+
+  }
+
+  ++m_misses;
+
+  try {
+
+    promise.set_value(fn());
+
+  } catch (...) {
+
+    {
+
+      ::std::lock_guard<::std::mutex> lock(s.mutex);
+
+      s.table.erase(key);
+
+    }
+
+    promise.set_exception(::std::current_exception());
+
+    throw;
+
+  }
+
+  ++m_inserts;
+
+  return value.get();
+
+}
+
+
+template <typename KEY, typename VALUE>
+void ConcurrentCache<KEY, VALUE>::clear() {
+
+  for (::std::size_t i = 0; i < m_size; ++i) {
+
+    m_shards[i].table.clear();
+
+  }
+
+}
+
+
+template <typename KEY, typename VALUE>
+CacheStats ConcurrentCache<KEY, VALUE>::stats() const {
+
+  ::std::size_t size = 0, buckets = 0;
+
+  for (::std::size_t i = 0; i < m_size; ++i) {
+
+    ::std::lock_guard<::std::mutex> lock(m_shards[i].mutex);
+
+    size += m_shards[i].table.size();
+    buckets += m_shards[i].table.bucket_count();
+
+  }
+
+  return {m_hits, m_misses, m_inserts, size, buckets,
+          buckets > 0 ? static_cast<double>(size) / buckets : 0.0, m_waits};
+
+}
+
+
+}
+
+
+#endif // ESF_MULTI_CONCURRENT_CACHE_HH
@@ -0,0 +1,329 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_engine.cc - Iterative evaluation of structured ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "concurrent_cache.hh"
+#include "esf_engine.hh"
+#include "esf_step.hh"
+#include "hit_prob.hh"
+#include "init.hh"
+#include "param.hh"
+#include "reach_cache.hh"
+#include "scratch_afs.hh"
+#include "thread_pool.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+namespace {
+
+
+// Returns the options with a single thread of the matrix-free solver
+// if solves run on a pool of more than one thread, so that the pool is
+// not oversubscribed.
+SolverOption nested_option(SolverOption option, ThreadPool const& pool) {
+
+  if (pool.size() > 1) {
+
+    option.threads = 1;
+
+  }
+
+  return option;
+
+}
+
+
+}
+
+
+ESFEngine::ESFEngine(Param const& param, SolverOption const& option,
+                     Index threads, ConcurrentCache<Init, HitProb>* hit_probs)
+    : m_param(param), m_pool(threads),
+      m_option(nested_option(option, m_pool)), m_nodes(0),
+      m_hit_probs(hit_probs), m_reach() {}
+
+
+double ESFEngine::compute(AFS const& afs) {
+
+  m_layers.clear();
+
+  m_nodes = 0;
+
+  explore(afs);
+
+  evaluate();
+
+  auto val = value(afs);
+
+  m_layers.clear();
+
+  m_reach.clear();
+
+  return val;
+
+}
+
+
+Index ESFEngine::nodes() const {
+
+  return m_nodes;
+
+}
+
+
+Index ESFEngine::threads() const {
+
+  return m_pool.size();
+
+}
+
+
+void ESFEngine::explore(AFS const& afs) {
+
+  using ::std::vector;
+
+  m_layers[afs.layer()].emplace(afs, 0.0);
+
+  vector<AFS const*> nodes;
+
+  vector<AFSTable> children;
+
+  // Dependencies are always in lower layers, which are visited after
+  // the current one.  Inserting into a map does not invalidate the
+  // iterator.
+  auto itr = m_layers.end();
+
+  while (itr != m_layers.begin()) {
+
+    --itr;
+
+    nodes.clear();
+
+    for (auto const& node: itr->second) {
+
+      nodes.push_back(&node.first);
+
+    }
+
+    children.assign(nodes.size(), AFSTable());
+
+    auto singleton = itr->first.second > 0;
+
+    m_pool.parallel_for_each(
+        0, sign(nodes.size()),
+        [&](Index i)
+        {
+          auto& found = children[unsign(i)];
+
+          // Children are copied once per node, however many terms
+          // lead to them.
+          auto record = [&found](ScratchAFS const& child)
+          {
+            found.intern(child);
+
+            return 0.0;
+          };
+
+          if (singleton) {
+
+            singleton_step(*nodes[unsign(i)], record);
+
+          } else {
+
+            auto term = [&record](ScratchAFS const& child, Index, Index, double)
+            {
+              record(child);
+            };
+
+            for (auto const& exit: m_reach.exits(*nodes[unsign(i)])) {
+
+              exit_terms(*exit.afs, exit.state, term);
+
+            }
+
+          }
+        });
+
+    for (auto const& found: children) {
+
+      for (AFSTable::id_type id = 0; id < found.size(); ++id) {
+
+        m_layers[found[id].layer()].emplace(found[id], 0.0);
+
+      }
+
+    }
+
+  }
+
+}
+
+
+void ESFEngine::evaluate() {
+
+  using ::std::vector;
+
+  // Hitting probabilities are shared by samples with the same initial
+  // condition.  Unless a cache is shared with other engines, those of
+  // smaller samples are dropped as evaluation moves up.
+  ConcurrentCache<Init, HitProb> local;
+
+  auto& hit_probs = m_hit_probs ? *m_hit_probs : local;
+
+  vector<table_type::value_type*> nodes;
+
+  ::std::unordered_set<Init> seen;
+
+  vector<Init> inits;
+
+  Index size = 0;
+
+  auto lookup = [this](AFS const& child)
+    {
+      return value(child);
+    };
+
+  // Tables of values are keyed by AFS, so a child modified in place is
+  // copied once to be looked up.
+  auto lookup_scratch = [this](ScratchAFS const& child)
+    {
+      return value(child.afs());
+    };
+
+  auto solve = [this, &hit_probs](Init const& init) -> HitProb const&
+    {
+      return hit_probs.get_or_compute(
+          init,
+          [this, &init]()
+          {
+            return HitProb(init, m_param, m_option);
+          });
+    };
+
+  for (auto itr = m_layers.begin(); itr != m_layers.end(); ++itr) {
+
+    if (itr->first.first != size) {
+
+      size = itr->first.first;
+
+      local.clear();
+
+      // Samples two genes smaller are no longer needed.
+      m_layers.erase(m_layers.begin(), m_layers.lower_bound({size - 1, 0}));
+
+    }
+
+    nodes.clear();
+
+    for (auto& node: itr->second) {
+
+      nodes.push_back(&node);
+
+    }
+
+    auto singleton = itr->first.second > 0;
+
+    if (!singleton) {
+
+      // Hitting probabilities are solved up front, one task per initial
+      // condition, so that no thread waits for another while the layer
+      // is evaluated.
+      seen.clear();
+      inits.clear();
+
+      for (auto node: nodes) {
+
+        Init init(node->first);
+
+        if (seen.insert(init).second) {
+
+          inits.push_back(init);
+
+        }
+
+      }
+
+      m_pool.parallel_for_each(0, sign(inits.size()),
+                               [&](Index i) { solve(inits[unsign(i)]); });
+
+    }
+
+    m_pool.parallel_for_each(
+        0, sign(nodes.size()),
+        [&](Index i)
+        {
+          auto node = nodes[unsign(i)];
+
+          if (singleton) {
+
+            node->second = singleton_step(node->first, lookup_scratch);
+
+          } else {
+
+            auto const& hit = solve(Init(node->first));
+
+            // Summed in the order of coalescence_step().
+            ChildWeights weights;
+
+            auto term = [&weights, &hit](ScratchAFS const& child, Index id,
+                                         Index deme, double coef)
+            {
+              weights.add(child, coef * hit.get(id, deme));
+            };
+
+            for (auto const& exit: m_reach.exits(node->first)) {
+
+              exit_terms(*exit.afs, exit.state, term);
+
+            }
+
+            node->second = weights.sum(lookup);
+
+          }
+        });
+
+    m_nodes += sign(nodes.size());
+
+  }
+
+}
+
+
+double& ESFEngine::value(AFS const& afs) {
+
+  return m_layers.at(afs.layer()).at(afs);
+
+}
+
+
+}
@@ -0,0 +1,134 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_engine.hh - Iterative evaluation of structured ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_ESF_ENGINE_HH
+#define ESF_MULTI_ESF_ENGINE_HH
+
+#include <map>
+#include <unordered_map>
+#include <utility>
+
+#include "afs.hh"
+#include "concurrent_cache.hh"
+#include "hit_prob.hh"
+#include "init.hh"
+#include "param.hh"
+#include "reach_cache.hh"
+#include "thread_pool.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class computes the same probabilities as ESFProb without
+// recursion.
+//
+// Samples, on which a probability depends, form a directed acyclic
+// graph.  A sample depends only on samples with one gene fewer and on
+// samples of the same size with fewer singletons, so the graph is
+// layered by the pair of the size and the number of singletons.  The
+// graph is first explored from the top layer down with an explicit
+// worklist, and probabilities are then evaluated layer by layer from
+// the bottom up.  Values are kept in a table keyed by samples, and
+// layers two sizes below the current one are discarded.  Neither the
+// depth of the stack nor the number of objects per sample depends on
+// the size of the sample.
+//
+// Samples in a layer do not depend on each other.  Both passes handle
+// one layer at a time, and samples of the layer are distributed over
+// threads of a work-stealing pool.  A layer is finished before the
+// next one starts.  Each probability is computed by the same
+// arithmetic as ESFProb, so results are identical bit for bit
+// regardless of the number of threads.
+//
+// Samples without singletons are expanded into the samples reacheable
+// by migrations once per computation, and both passes share the
+// expansion.
+class ESFEngine {
+
+ public:
+
+  // Size of samples and the number of singleton alleles.
+  typedef AFS::layer_type layer_type;
+
+ private:
+
+  typedef ::std::unordered_map<AFS, double> table_type;
+
+  Param const m_param;
+
+  ThreadPool m_pool;
+
+  // Options of hitting probabilities solved on the pool.
+  SolverOption const m_option;
+
+  ::std::map<layer_type, table_type> m_layers;
+
+  Index m_nodes;
+
+  ConcurrentCache<Init, HitProb>* m_hit_probs;
+
+  ReachCache m_reach;
+
+  void explore(AFS const&);
+
+  void evaluate();
+
+  double& value(AFS const&);
+
+ public:
+
+  // Evaluation runs on the specified number of threads.  Zero means
+  // the number of hardware threads.  Hitting probabilities may be kept
+  // in a cache shared with other engines of the same parameters and
+  // solver options, possibly running on other threads.  If the engine
+  // runs on more than one thread, hitting probabilities are solved on
+  // the threads of the engine, one initial condition per task, and the
+  // matrix-free solver does not start threads of its own.
+  ESFEngine(Param const&, SolverOption const& = SolverOption(), Index = 1,
+            ConcurrentCache<Init, HitProb>* = nullptr);
+
+  ESFEngine(ESFEngine const&) = delete;
+
+  ESFEngine& operator=(ESFEngine const&) = delete;
+
+  ~ESFEngine() = default;
+
+  // Returns the number of threads.
+  Index threads() const;
+
+  // Returns the probability of a sample.
+  double compute(AFS const&);
+
+  // Returns the number of samples evaluated by the last computation.
+  Index nodes() const;
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_ESF_ENGINE_HH
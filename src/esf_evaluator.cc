@@ -0,0 +1,126 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_evaluator.cc - Evaluation of compiled recursion of ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <memory>
+#include <vector>
+
+#include "esf_evaluator.hh"
+#include "esf_graph.hh"
+#include "hit_prob.hh"
+#include "hit_prob_store.hh"
+#include "param.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+ESFEvaluator::ESFEvaluator(::std::shared_ptr<ESFGraph const> const& graph,
+                           SolverOption const& option, HitProbStore* store)
+    : m_graph(graph), m_option(option), m_store(store),
+      m_hit_probs(graph->inits().size()), m_ready(graph->inits().size(), false),
+      m_hits(graph->hits().size(), 1.0), m_values(unsign(graph->nodes()), 0.0) {}
+
+
+ESFGraph const& ESFEvaluator::graph() const {
+
+  return *m_graph;
+
+}
+
+
+void ESFEvaluator::solve(Param const& param) {
+
+  auto const& inits = m_graph->inits();
+
+  for (decltype(inits.size()) i = 0; i < inits.size(); ++i) {
+
+    auto& hit_prob = m_hit_probs[i];
+
+    HitProb found;
+
+    if (m_store && m_store->find(inits[i], param, m_option, found)) {
+
+      hit_prob = m_ready[i] ? hit_prob.update(param, found.values()) : found;
+
+    } else {
+
+      hit_prob = m_ready[i] ? hit_prob.update(param) : HitProb(inits[i], param, m_option);
+
+      if (m_store) {
+
+        m_store->insert(hit_prob);
+
+      }
+
+    }
+
+    m_ready[i] = true;
+
+  }
+
+  auto const& hits = m_graph->hits();
+
+  // The first slot stays one.
+  for (decltype(hits.size()) i = 1; i < hits.size(); ++i) {
+
+    auto const& slot = hits[i];
+
+    m_hits[i] = m_hit_probs[unsign(slot.init)].get(slot.state, slot.deme);
+
+  }
+
+}
+
+
+double ESFEvaluator::compute(Param const& param) {
+
+  solve(param);
+
+  auto const& constants = m_graph->constants();
+  auto const& first = m_graph->first();
+  auto const& terms = m_graph->terms();
+
+  for (decltype(constants.size()) n = 0; n < constants.size(); ++n) {
+
+    double val = constants[n];
+
+    for (auto t = first[n]; t < first[n + 1]; ++t) {
+
+      auto const& term = terms[unsign(t)];
+
+      val += term.coef * m_hits[unsign(term.hit)] * m_values[unsign(term.child)];
+
+    }
+
+    m_values[n] = val;
+
+  }
+
+  return m_values[unsign(m_graph->root())];
+
+}
+
+
+}
@@ -0,0 +1,93 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_evaluator.hh - Evaluation of compiled recursion of ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_ESF_EVALUATOR_HH
+#define ESF_MULTI_ESF_EVALUATOR_HH
+
+#include <memory>
+#include <vector>
+
+#include "esf_graph.hh"
+#include "hit_prob.hh"
+#include "hit_prob_store.hh"
+#include "param.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class evaluates a compiled recursion of ESF for one set of
+// parameters after another.  Hitting probabilities are solved once
+// per initial condition and parameters, and later parameters reuse
+// the structure of the generator and the symbolic analysis through
+// HitProb::update().  The rest of evaluation is a single sweep over
+// nodes of the graph, without enumerating samples.  Hitting
+// probabilities may be looked up in and added to a persistent store,
+// and those found there keep the structure for later parameters.
+class ESFEvaluator {
+
+ private:
+
+  ::std::shared_ptr<ESFGraph const> m_graph;
+
+  SolverOption const m_option;
+
+  HitProbStore* m_store;
+
+  ::std::vector<HitProb> m_hit_probs;
+
+  // Whether each of m_hit_probs has been solved or loaded, so that it
+  // can be updated.  Entries stay unset if a solve fails.
+  ::std::vector<bool> m_ready;
+
+  ::std::vector<double> m_hits;
+
+  ::std::vector<double> m_values;
+
+  void solve(Param const&);
+
+ public:
+
+  ESFEvaluator(::std::shared_ptr<ESFGraph const> const&,
+               SolverOption const& = SolverOption(), HitProbStore* = nullptr);
+
+  ESFEvaluator(ESFEvaluator const&) = delete;
+
+  ESFEvaluator& operator=(ESFEvaluator const&) = delete;
+
+  ~ESFEvaluator() = default;
+
+  ESFGraph const& graph() const;
+
+  // Returns the probability of the sample the graph is compiled from.
+  double compute(Param const&);
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_ESF_EVALUATOR_HH
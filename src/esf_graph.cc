@@ -0,0 +1,559 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_graph.cc - Compiled recursion of ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "esf_graph.hh"
+#include "esf_step.hh"
+#include "init.hh"
+#include "mapped_file.hh"
+#include "scratch_afs.hh"
+#include "state.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+namespace {
+
+
+// Arrays of a graph compiled in memory.
+struct GraphArrays {
+
+  ::std::vector<ESFGraph::HitSlot> hits;
+
+  ::std::vector<double> constants;
+
+  ::std::vector<Index> first;
+
+  ::std::vector<ESFGraph::Term> terms;
+
+};
+
+
+// Header of a graph file.  Arrays follow in the order of the counts.
+// Every array element is a multiple of eight bytes, so that arrays
+// stay aligned in a mapped file.
+struct GraphHeader {
+
+  char magic[8];
+
+  ::std::uint32_t version;
+
+  ::std::uint32_t byte_order;
+
+  ::std::uint32_t index_size;
+
+  ::std::uint32_t term_size;
+
+  ::std::uint64_t demes;
+
+  ::std::uint64_t inits;
+
+  ::std::uint64_t hits;
+
+  ::std::uint64_t nodes;
+
+  ::std::uint64_t terms;
+
+};
+
+
+char const graph_magic[8] = {'E', 'S', 'F', 'G', 'R', 'A', 'P', 'H'};
+
+::std::uint32_t const graph_version = 1;
+
+::std::uint32_t const graph_byte_order = 0x01020304;
+
+
+static_assert(sizeof(GraphHeader) % 8 == 0, "header breaks alignment");
+static_assert(sizeof(Index) == 8, "graph files assume 64 bit indices");
+static_assert(sizeof(ESFGraph::HitSlot) == 3 * sizeof(Index),
+              "hit slots must not be padded");
+static_assert(sizeof(ESFGraph::Term) == 2 * sizeof(Index) + sizeof(double),
+              "terms must not be padded");
+static_assert(::std::is_standard_layout<ESFGraph::Term>::value,
+              "terms are written as bytes");
+
+
+// Adds the size of an array of count elements to the total.  Returns
+// false if the size does not fit.
+bool add_array_size(::std::uint64_t& total, ::std::uint64_t count,
+                    ::std::uint64_t size) {
+
+  auto max = ::std::numeric_limits<::std::uint64_t>::max();
+
+  if (size != 0 && (count > max / size || count * size > max - total)) {
+
+    return false;
+
+  }
+
+  total += count * size;
+
+  return true;
+
+}
+
+
+// Computes the size of a file from counts of its header, which are not
+// trusted.  Returns false if the size does not fit.
+bool graph_file_size(GraphHeader const& h, ::std::uint64_t& size) {
+
+  size = sizeof(GraphHeader);
+
+  return h.demes <= ::std::numeric_limits<::std::uint64_t>::max() / sizeof(Index)
+      && add_array_size(size, h.inits, h.demes * sizeof(Index))
+      && add_array_size(size, h.hits, sizeof(ESFGraph::HitSlot))
+      && add_array_size(size, h.nodes, sizeof(double))
+      && h.nodes < ::std::numeric_limits<::std::uint64_t>::max()
+      && add_array_size(size, h.nodes + 1, sizeof(Index))
+      && add_array_size(size, h.terms, sizeof(ESFGraph::Term));
+
+}
+
+
+template <typename T>
+void write_array(::std::ofstream& out, T const* data, ::std::size_t size) {
+
+  out.write(reinterpret_cast<char const*>(data),
+            static_cast<::std::streamsize>(size * sizeof(T)));
+
+}
+
+
+template <typename T>
+ArrayView<T> read_array(char const*& pos, ::std::size_t size) {
+
+  ArrayView<T> view(reinterpret_cast<T const*>(pos), size);
+
+  pos += size * sizeof(T);
+
+  return view;
+
+}
+
+
+}
+
+
+ESFGraph::ESFGraph(AFS const& afs) {
+
+  using ::std::vector;
+
+  auto arrays = ::std::make_shared<GraphArrays>();
+
+  AFSTable table;
+
+  table.intern(afs);
+
+  // Terms and constants of nodes in the order of IDs, and children
+  // are referred to by IDs until nodes are sorted.
+  vector<vector<Term>> terms;
+
+  vector<double> constants;
+
+  ::std::unordered_map<Init, Index> inits;
+
+  // Alleles recur across nodes, and their exits are expanded once.
+  AlleleExitCache alleles;
+
+  // Slots of each initial condition, keyed in the same way as
+  // HitProb::get(Index, Index).
+  vector<::std::unordered_map<Index, Index>> slots;
+
+  arrays->hits.push_back({-1, 0, 0});
+
+  // Children are interned as they are found, and visited later in the
+  // same loop.
+  for (AFSTable::id_type id = 0; id < table.size(); ++id) {
+
+    // Interned AFS stay in place while children are interned.
+    AFS const& node = table[id];
+
+    terms.emplace_back();
+
+    constants.push_back(node.size() == 1 ? 1.0 : 0.0);
+
+    auto& found = terms.back();
+
+    if (node.singleton()) {
+
+      singleton_terms(node,
+                      [&](ScratchAFS const& child, double coef)
+                      {
+                        found.push_back({sign(table.intern(child)), 0, coef});
+                      });
+
+      continue;
+
+    }
+
+    Init init(node);
+
+    auto inserted = inits.emplace(init, sign(m_inits.size()));
+
+    if (inserted.second) {
+
+      m_inits.push_back(init);
+
+      slots.emplace_back();
+
+    }
+
+    auto index = inserted.first->second;
+
+    auto& slot = slots[unsign(index)];
+
+    coalescence_terms(node, alleles,
+                      [&](ScratchAFS const& child, State const& state, Index deme,
+                          double coef)
+                      {
+                        auto key = init.deme() * state.id() + deme;
+
+                        auto hit = slot.emplace(key, sign(arrays->hits.size()));
+
+                        if (hit.second) {
+
+                          arrays->hits.push_back({index, state.id(), deme});
+
+                        }
+
+                        found.push_back({sign(table.intern(child)),
+                                         hit.first->second, coef});
+                      });
+
+  }
+
+  // Children are in lower layers than their parents, and the sample
+  // compiled from is alone in the top layer.
+  vector<AFS::layer_type> layers;
+
+  for (AFSTable::id_type id = 0; id < table.size(); ++id) {
+
+    layers.push_back(table[id].layer());
+
+  }
+
+  vector<Index> order(table.size());
+
+  ::std::iota(order.begin(), order.end(), 0);
+
+  ::std::stable_sort(order.begin(), order.end(),
+                     [&layers](Index a, Index b)
+                     {
+                       return layers[unsign(a)] < layers[unsign(b)];
+                     });
+
+  vector<Index> position(order.size());
+
+  for (decltype(order.size()) i = 0; i < order.size(); ++i) {
+
+    position[unsign(order[i])] = sign(i);
+
+  }
+
+  arrays->first.push_back(0);
+
+  for (auto id: order) {
+
+    arrays->constants.push_back(constants[unsign(id)]);
+
+    for (auto term: terms[unsign(id)]) {
+
+      term.child = position[unsign(term.child)];
+
+      arrays->terms.push_back(term);
+
+    }
+
+    arrays->first.push_back(sign(arrays->terms.size()));
+
+  }
+
+  m_hits = arrays->hits;
+  m_constants = arrays->constants;
+  m_first = arrays->first;
+  m_terms = arrays->terms;
+
+  m_storage = arrays;
+
+}
+
+
+void ESFGraph::save(::std::string const& path) const {
+
+  GraphHeader header;
+
+  ::std::memcpy(header.magic, graph_magic, sizeof(graph_magic));
+
+  header.version = graph_version;
+  header.byte_order = graph_byte_order;
+  header.index_size = sizeof(Index);
+  header.term_size = sizeof(Term);
+  header.demes = m_inits.empty() ? 0 : unsign(m_inits.front().deme());
+  header.inits = m_inits.size();
+  header.hits = m_hits.size();
+  header.nodes = m_constants.size();
+  header.terms = m_terms.size();
+
+  ::std::vector<Index> genes;
+
+  for (auto const& init: m_inits) {
+
+    genes.insert(genes.end(), init.begin(), init.end());
+
+  }
+
+  // An empty graph is saved with a single offset of terms.
+  ::std::vector<Index> first(m_first.begin(), m_first.end());
+
+  if (first.empty()) {
+
+    first.push_back(0);
+
+  }
+
+  ::std::ofstream out(path, ::std::ios::binary | ::std::ios::trunc);
+
+  write_array(out, &header, 1);
+  write_array(out, genes.data(), genes.size());
+  write_array(out, m_hits.data(), m_hits.size());
+  write_array(out, m_constants.data(), m_constants.size());
+  write_array(out, first.data(), first.size());
+  write_array(out, m_terms.data(), m_terms.size());
+
+  out.close();
+
+  if (!out) {
+
+    throw ::std::runtime_error("cannot write ESF graph: " + path);
+
+  }
+
+}
+
+
+ESFGraph ESFGraph::map(::std::string const& path) {
+
+  auto file = ::std::make_shared<MappedFile>(path);
+
+  if (file->size() < sizeof(GraphHeader)) {
+
+    throw ::std::runtime_error("not an ESF graph: " + path);
+
+  }
+
+  auto const& header = *reinterpret_cast<GraphHeader const*>(file->data());
+
+  if (::std::memcmp(header.magic, graph_magic, sizeof(graph_magic)) != 0
+      || header.byte_order != graph_byte_order) {
+
+    throw ::std::runtime_error("not an ESF graph: " + path);
+
+  }
+
+  if (header.version != graph_version
+      || header.index_size != sizeof(Index)
+      || header.term_size != sizeof(Term)) {
+
+    throw ::std::runtime_error("unsupported ESF graph format: " + path);
+
+  }
+
+  ::std::uint64_t size;
+
+  if (!graph_file_size(header, size) || header.nodes == 0) {
+
+    throw ::std::runtime_error("corrupted ESF graph: " + path);
+
+  }
+
+  if (size != file->size()) {
+
+    throw ::std::runtime_error("truncated ESF graph: " + path);
+
+  }
+
+  ESFGraph graph;
+
+  auto pos = file->data() + sizeof(GraphHeader);
+
+  auto genes = read_array<Index>(pos, header.inits * header.demes);
+
+  if (::std::any_of(genes.begin(), genes.end(), [](Index i) { return i < 0; })) {
+
+    throw ::std::runtime_error("corrupted ESF graph: " + path);
+
+  }
+
+  for (decltype(header.inits) i = 0; i < header.inits; ++i) {
+
+    auto begin = genes.begin() + i * header.demes;
+
+    // Counts of genes too large for the number of states are corrupted.
+    try {
+
+      graph.m_inits.push_back(Init(::std::vector<Index>(begin, begin + header.demes)));
+
+    } catch (::std::overflow_error const&) {
+
+      throw ::std::runtime_error("corrupted ESF graph: " + path);
+
+    }
+
+  }
+
+  graph.m_hits = read_array<HitSlot>(pos, header.hits);
+  graph.m_constants = read_array<double>(pos, header.nodes);
+  graph.m_first = read_array<Index>(pos, header.nodes + 1);
+  graph.m_terms = read_array<Term>(pos, header.terms);
+
+  if (!graph.valid()) {
+
+    throw ::std::runtime_error("corrupted ESF graph: " + path);
+
+  }
+
+  graph.m_storage = file;
+
+  return graph;
+
+}
+
+
+bool ESFGraph::valid() const {
+
+  auto nodes = m_constants.size();
+
+  // The root is the last node, so there is at least one.
+  if (nodes == 0 || m_first[0] != 0 || unsign(m_first[nodes]) != m_terms.size()) {
+
+    return false;
+
+  }
+
+  // Numbers of states of initial conditions, which may not fit.
+  ::std::vector<Index> dims;
+
+  for (auto const& init: m_inits) {
+
+    try {
+
+      dims.push_back(init.dim());
+
+    } catch (::std::overflow_error const&) {
+
+      return false;
+
+    }
+
+  }
+
+  // The first slot stands for one, and it does not refer to an initial
+  // condition.
+  for (decltype(m_hits.size()) i = 1; i < m_hits.size(); ++i) {
+
+    auto const& slot = m_hits[i];
+
+    if (slot.init < 0 || unsign(slot.init) >= m_inits.size()) {
+
+      return false;
+
+    }
+
+    auto const& init = m_inits[unsign(slot.init)];
+
+    if (slot.state < 0 || slot.state >= dims[unsign(slot.init)]
+        || slot.deme < 0 || slot.deme >= init.deme()) {
+
+      return false;
+
+    }
+
+  }
+
+  for (decltype(nodes) i = 0; i < nodes; ++i) {
+
+    if (m_first[i] > m_first[i + 1]) {
+
+      return false;
+
+    }
+
+  }
+
+  // Children come before their parents, so that every child is
+  // evaluated before it is read.
+  for (decltype(nodes) i = 0; i < nodes; ++i) {
+
+    for (auto k = unsign(m_first[i]); k < unsign(m_first[i + 1]); ++k) {
+
+      auto const& term = m_terms[k];
+
+      if (term.child < 0 || unsign(term.child) >= i
+          || term.hit < 0 || unsign(term.hit) >= m_hits.size()) {
+
+        return false;
+
+      }
+
+    }
+
+  }
+
+  return true;
+
+}
+
+
+Index ESFGraph::nodes() const {
+
+  return sign(m_constants.size());
+
+}
+
+
+Index ESFGraph::root() const {
+
+  return nodes() - 1;
+
+}
+
+
+}
@@ -0,0 +1,148 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_graph.hh - Compiled recursion of ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_ESF_GRAPH_HH
+#define ESF_MULTI_ESF_GRAPH_HH
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "afs.hh"
+#include "array_view.hh"
+#include "init.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class holds the recursion of ESF from a sample as a directed
+// acyclic graph.  The graph does not depend on demographic
+// parameters: it records which samples each sample depends on, the
+// combinatorial coefficients, and which hitting probability each term
+// is weighted by.  Evaluation for a given set of parameters fills in
+// hitting probabilities and sweeps nodes in order (see ESFEvaluator).
+//
+// Nodes are sorted so that children come before their parents, and
+// the sample the graph is compiled from is the last node.  The value
+// of a node is its constant plus the sum of coef * hit * value of
+// child over its terms.  Hitting probabilities are referred to by
+// slots, and the first slot stands for one.
+//
+// A graph can be saved to a binary file and mapped back into memory.
+// Arrays of a mapped graph are read directly from the file, which is
+// shared by all processes mapping it.  The file starts with a header
+// of the format version, the byte order and sizes of types, followed
+// by counts of genes of initial conditions, hitting probability
+// slots, constants of nodes, offsets of terms, and terms.  A file is
+// read only by a build with the same format version and type sizes.
+// Copies of a graph share the arrays.
+class ESFGraph {
+
+ public:
+
+  struct Term {
+
+    Index child;
+
+    Index hit;
+
+    double coef;
+
+  };
+
+  // A hitting probability of the state and the deme of coalescence,
+  // under the initial condition of the index.
+  struct HitSlot {
+
+    Index init;
+
+    Index state;
+
+    Index deme;
+
+  };
+
+ private:
+
+  ::std::vector<Init> m_inits;
+
+  // Owns arrays below, either vectors or a mapped file.
+  ::std::shared_ptr<void const> m_storage;
+
+  ArrayView<HitSlot> m_hits;
+
+  ArrayView<double> m_constants;
+
+  // Terms of i-th node are in [m_first[i], m_first[i + 1]).
+  ArrayView<Index> m_first;
+
+  ArrayView<Term> m_terms;
+
+  // Tests if there is a node, if offsets of terms are non-decreasing
+  // and cover all terms, and if every index in terms and hitting
+  // probability slots is in range.
+  bool valid() const;
+
+ public:
+
+  ESFGraph() = default;
+
+  // Compiles the recursion from the sample.
+  explicit ESFGraph(AFS const&);
+
+  // Writes the graph to a file.  Throws std::runtime_error if the file
+  // cannot be written.
+  void save(::std::string const&) const;
+
+  // Maps a file written by save() read-only.  Throws
+  // std::runtime_error if the file cannot be mapped, if it is not a
+  // graph of this format version and type sizes, if its counts do not
+  // fit, if it has no node, or if its offsets or indices are out of
+  // range.
+  static ESFGraph map(::std::string const&);
+
+  Index nodes() const;
+
+  // Returns the index of the node of the sample compiled from.
+  Index root() const;
+
+  ::std::vector<Init> const& inits() const { return m_inits; }
+
+  ArrayView<HitSlot> const& hits() const { return m_hits; }
+
+  ArrayView<double> const& constants() const { return m_constants; }
+
+  ArrayView<Index> const& first() const { return m_first; }
+
+  ArrayView<Term> const& terms() const { return m_terms; }
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_ESF_GRAPH_HH
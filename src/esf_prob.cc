@@ -24,13 +24,15 @@
 // DEALINGS IN THE SOFTWARE.
 
 #include <algorithm>
-#include <stdexcept>
 
 #include "afs.hh"
+#include "afs_cache.hh"
 #include "allele.hh"
 #include "cache.hh"
 #include "hit_prob.hh"
 #include "esf_prob.hh"
+#include "esf_step.hh"
+#include "scratch_afs.hh"
 #include "util.hh"
 
 namespace esf {
@@ -42,77 +44,66 @@ ESFProb::~ESFProb() {
 
     delete m_esf_prob_cache;
     delete m_hit_prob_cache;
+    delete m_allele_cache;
 
   }
 
 }
 
 
-ESFProb::ESFProb(AFS const& a, Param const& p)
-    : m_afs(a), m_init(a), m_param(p),
-      m_esf_prob_cache(new Cache<AFS, double>(m_afs)),
-      m_hit_prob_cache(new Cache<Init, HitProb>(m_init)) {}
+ESFProb::ESFProb(AFS const& a, Param const& p, SolverOption const& o)
+    : m_afs(a), m_init(a), m_param(p), m_option(o),
+      m_esf_prob_cache(new AFSCache(m_afs)),
+      m_hit_prob_cache(new Cache<Init, HitProb>(m_init)),
+      m_allele_cache(new AlleleExitCache()),
+      m_store(nullptr), m_hit_prob_store(nullptr), m_fingerprint(0) {}
 
 
-ESFProb::ESFProb(AFS const& a, Param const& p,
-                 Cache<AFS, double>* esf_prob_cache,
-                 Cache<Init, HitProb>* hit_prob_cache)
-    : m_afs(a), m_init(a), m_param(p),
-      m_esf_prob_cache(esf_prob_cache),
-      m_hit_prob_cache(hit_prob_cache) {}
-
-
-double ESFProb::compute() {
+ESFProb::ESFProb(AFS const& a, Param const& p, SolverOption const& o,
+                 ESFStore* store, HitProbStore* hit_prob_store)
+    : m_afs(a), m_init(a), m_param(p), m_option(o),
+      m_esf_prob_cache(new AFSCache(m_afs)),
+      m_hit_prob_cache(new Cache<Init, HitProb>(m_init)),
+      m_allele_cache(new AlleleExitCache()),
+      m_store(store), m_hit_prob_store(hit_prob_store),
+      m_fingerprint(store ? p.fingerprint() : 0) {}
 
-  try {
 
-    return m_esf_prob_cache->at(m_afs);
-
-  } catch (::std::out_of_range&) {
+ESFProb::ESFProb(AFS const& a, Param const& p, SolverOption const& o,
+                 AFSCache* esf_prob_cache,
+                 Cache<Init, HitProb>* hit_prob_cache,
+                 AlleleExitCache* allele_cache,
+                 ESFStore* store, HitProbStore* hit_prob_store)
+    : m_afs(a), m_init(a), m_param(p), m_option(o),
+      m_esf_prob_cache(esf_prob_cache),
+      m_hit_prob_cache(hit_prob_cache),
+      m_allele_cache(allele_cache),
+      m_store(store), m_hit_prob_store(hit_prob_store),
+      m_fingerprint(store ? p.fingerprint() : 0) {}
 
-    double val;
 
-    if (m_afs.singleton()) {
+double ESFProb::compute() {
 
-      val = compute_with_singleton();
+  return m_esf_prob_cache->get_or_compute(m_afs, [this]() { return evaluate(); });
 
+}
 
-    } else {
 
-      val = compute_without_singleton();
+double ESFProb::evaluate() {
 
-    }
+  double val;
 
-    (*m_esf_prob_cache)[m_afs] = val;
+  if (m_store && m_store->find(m_fingerprint, m_option, m_afs, val)) {
 
     return val;
 
   }
 
-}
-
-
-double ESFProb::compute_without_singleton() {
-
-  double val = 0.0;
+  val = m_afs.singleton() ? compute_with_singleton() : compute_without_singleton();
 
-  HitProb hp;
+  if (m_store) {
 
-  try {
-
-    hp = m_hit_prob_cache->at(m_init);
-
-  } catch (::std::out_of_range&) {
-
-    hp = HitProb(m_init, m_param);
-
-    (*m_hit_prob_cache)[m_init] = hp;
-
-  }
-
-  for (auto spec: m_afs.reacheable()) {
-
-    val += compute_coal_probs(spec, hp);
+    m_store->insert(m_fingerprint, m_option, m_afs, val);
 
   }
 
@@ -121,94 +112,73 @@ double ESFProb::compute_without_singleton() {
 }
 
 
-Value ESFProb::compute_with_singleton() {
-
-  if (m_afs.size() == 1) {
-
-    return 1.0;
-
-  }
-
-  using ::std::find_if;
-
-  auto singleton = find_if(m_afs.begin(), m_afs.end(),
-                           [](AFS::value_type p)
-                           {
-                             return p.first.singleton();
-                           });
-
-  Allele allele = singleton->first;
-
-  decltype(m_afs.deme()) deme = 0;
-  while (allele[deme] == 0) {
-
-    ++deme;
-
-  }
-
-  double dsize = static_cast<double>(m_afs.size(deme));
-
-  AFS base = m_afs.remove(allele).add(allele.remove(deme));
-
-  // probability of a sample excluding one of singleton alleles.
-  double val = ESFProb(base, m_param, m_esf_prob_cache, m_hit_prob_cache).compute();
-
-  for (auto a: base) {
-
-    // add a gene to previously an observed allele.
-    Allele na = a.first.add(deme);
+double ESFProb::compute_without_singleton() {
 
-    AFS other = base.remove(a.first).add(na);
+  // Values in the cache stay in place as the recursion adds more.
+  HitProb const& hp = m_hit_prob_cache->get_or_compute(
+      m_init,
+      [this]()
+      {
+        return m_hit_prob_store
+          ? m_hit_prob_store->get_or_compute(m_init, m_param, m_option)
+          : HitProb(m_init, m_param, m_option);
+      });
+
+  return coalescence_step(m_afs, *m_allele_cache, hp,
+                          [this](AFS const& afs)
+                          {
+                            return ESFProb(afs, m_param, m_option, m_esf_prob_cache,
+                                           m_hit_prob_cache, m_allele_cache,
+                                           m_store, m_hit_prob_store).compute();
+                          });
 
-    val -= ESFProb(other, m_param, m_esf_prob_cache, m_hit_prob_cache).compute() * \
-        other[na] * na[deme] / dsize;
+}
 
 
-  }
+double ESFProb::compute_with_singleton() {
 
-  val *= dsize / m_afs[allele];
+  // Children are looked up in place, and a child ESFProb is made only
+  // on a miss.
+  auto child = [this](AFS const& afs)
+    {
+      return ESFProb(afs, m_param, m_option, m_esf_prob_cache,
+                     m_hit_prob_cache, m_allele_cache, m_store,
+                     m_hit_prob_store).evaluate();
+    };
 
-  return val;
+  return singleton_step(m_afs,
+                        [this, &child](ScratchAFS const& afs)
+                        {
+                          return m_esf_prob_cache->get_or_compute(afs, child);
+                        });
 
 }
 
 
-double ESFProb::compute_coal_probs(ExitAFSPair const& pair, HitProb const& hp) {
-
-  double val = 0.0;
-  AFS afs = pair.afs;
-  State state = pair.state;
-
-  auto deme = m_init.deme();
+CacheStats ESFProb::esf_prob_cache_stats() const {
 
-  for (auto a: afs) {
+  return m_esf_prob_cache->stats();
 
-    auto allele = a.first;
-
-    AFS other0 = afs.remove(allele);
+}
 
-    for (Index i = 0; i < deme; ++i) {
 
-      if (allele[i] > 1) {
+CacheStats ESFProb::hit_prob_cache_stats() const {
 
-        Allele na = allele.remove(i);
+  return m_hit_prob_cache->stats();
 
-        AFS other1 = other0.add(na);
+}
 
-        double tmp = hp.get(state, i) * \
-            ESFProb(other1, m_param, m_esf_prob_cache, m_hit_prob_cache).compute();
 
-        tmp *= na.size() * other1[na] / other1.size();
+HashDiagnostics ESFProb::esf_prob_cache_diagnostics() const {
 
-        val += tmp;
+  return m_esf_prob_cache->diagnostics();
 
-      }
+}
 
-    }
 
-  }
+HashDiagnostics ESFProb::hit_prob_cache_diagnostics() const {
 
-  return val;
+  return m_hit_prob_cache->diagnostics();
 
 }
 
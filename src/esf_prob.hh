@@ -26,18 +26,21 @@
 #ifndef ESF_MULTI_ESF_PROB_HH
 #define ESF_MULTI_ESF_PROB_HH
 
+#include <cstdint>
+
 #include "typedef.hh"
 #include "afs.hh"
+#include "afs_cache.hh"
+#include "cache.hh"
+#include "esf_store.hh"
 #include "hit_prob.hh"
+#include "hit_prob_store.hh"
 #include "param.hh"
 #include "typedef.hh"
 
 namespace esf {
 
 
-template <typename KEY, typename VALUE> class Cache;
-
-
 // An instance of this class computes probabilities of an allele
 // frequency spectrum according to population-structured extension to
 // Ewen's sampling formula.
@@ -51,16 +54,28 @@ class ESFProb {
 
   Param const m_param;
 
-  Cache<AFS, double>*  m_esf_prob_cache;
+  SolverOption const m_option;
+
+  AFSCache* m_esf_prob_cache;
 
   Cache<Init, HitProb>* m_hit_prob_cache;
 
+  AlleleExitCache* m_allele_cache;
+
+  ESFStore* m_store;
+
+  HitProbStore* m_hit_prob_store;
+
+  ::std::uint64_t m_fingerprint;
+
+  // Computes the probability without looking up the cache of
+  // probabilities.
+  double evaluate();
+
   double compute_with_singleton();
 
   double compute_without_singleton();
 
-  double compute_coal_probs(ExitAFSPair const&, HitProb const&);
-
  public:
 
   // ESFProb() = delete;
@@ -74,9 +89,19 @@ class ESFProb {
   // This constructor takes an allele frequency spectrum (of AFS
   // class) and demographic paramegers of (Param class).  The acutual
   // computation is deferred until compute method is explicitly invoked.
-  ESFProb(AFS const&, Param const&);
+  // Hitting probabilities are computed with the specified solver.
+  ESFProb(AFS const&, Param const&, SolverOption const& = SolverOption());
 
-  ESFProb(AFS const&, Param const&, Cache<AFS, double>*, Cache<Init, HitProb>*);
+  // Probabilities, and optionally hitting probabilities, are looked
+  // up in persistent stores before they are computed, and new ones are
+  // added to them.  Either store may be null.
+  ESFProb(AFS const&, Param const&, SolverOption const&, ESFStore*,
+          HitProbStore* = nullptr);
+
+  ESFProb(AFS const&, Param const&, SolverOption const&,
+          AFSCache*, Cache<Init, HitProb>*, AlleleExitCache*,
+          ESFStore* = nullptr,
+          HitProbStore* = nullptr);
 
   // This function implements actual computation of
   // population-structured ESP, and it's return value is a probability
@@ -84,6 +109,16 @@ class ESFProb {
   // demographic parameters.  The computation is performed recursively.
   double compute();
 
+  // Returns counters of caches shared by the recursion.
+  CacheStats esf_prob_cache_stats() const;
+
+  CacheStats hit_prob_cache_stats() const;
+
+  // Returns how keys of the caches are spread over buckets.
+  HashDiagnostics esf_prob_cache_diagnostics() const;
+
+  HashDiagnostics hit_prob_cache_diagnostics() const;
+
   friend void swap(ESFProb&, ESFProb&);
 
 };
@@ -0,0 +1,330 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_step.hh - One step of the recursion of structured ESF
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_ESF_STEP_HH
+#define ESF_MULTI_ESF_STEP_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "allele.hh"
+#include "scratch_afs.hh"
+#include "state.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// These functions compute the probability of a sample from
+// probabilities of the samples it depends on.  The latter are obtained
+// by calling prob(), so that the recursive ESFProb and the iterative
+// ESFEngine share exactly the same arithmetic.  A callback, which
+// records its argument and returns zero, enumerates dependencies
+// instead.
+//
+// Samples are derived from their parent by changing one allele of a
+// ScratchAFS in place and undoing it afterwards, and a callback makes
+// a persistent AFS only if it keeps the sample.
+
+// A sample with a singleton allele depends on samples with one gene
+// fewer and on samples of the same size with fewer singletons, which
+// are passed to prob(ScratchAFS const&).
+template <typename PROB>
+double singleton_step(AFS const&, PROB);
+
+// A sample without singletons depends on samples with one gene fewer,
+// weighted by hitting probabilities, which are looked up by
+// hit.get(Index, Index) with the ID of a state and a deme.  Many exits
+// lead to the same child, so weights are first summed per distinct
+// child, and prob(AFS const&) is then called once per child in the
+// order children are first seen.  Exits of alleles are looked up in
+// the cache, which is owned by the caller.
+template <typename HIT, typename PROB>
+double coalescence_step(AFS const&, AlleleExitCache&, HIT const&, PROB);
+
+// These functions enumerate terms of the steps above instead of
+// evaluating them, so that the recursion can be compiled once and
+// evaluated for many parameters.  The probability of a sample is the
+// sum of coef * prob(child) over terms passed to term(child, coef),
+// and of coef * hit.get(state, deme) * prob(child) over terms passed
+// to term(child, state, deme, coef).  Children are passed as
+// ScratchAFS.  A sample of a single gene has no terms, and its
+// probability is one.  Terms with zero coefficient are skipped.
+template <typename TERM>
+void singleton_terms(AFS const&, TERM);
+
+template <typename TERM>
+void coalescence_terms(AFS const&, AlleleExitCache&, TERM);
+
+// Enumerates terms of coalescence_terms() for one exit, given the AFS
+// reached by migrations and the ID of its state.
+template <typename TERM>
+void exit_terms(AFS const&, Index, TERM);
+
+
+// This class sums weights of children of a sample per distinct child,
+// keeping the order in which children are first added.  Children are
+// interned, so a persistent AFS is made once per distinct child.
+class ChildWeights {
+
+  AFSTable m_children;
+
+  ::std::vector<double> m_weights;
+
+ public:
+
+  void add(ScratchAFS const& child, double weight) {
+
+    auto id = m_children.intern(child);
+
+    if (id == m_weights.size()) {
+
+      m_weights.push_back(weight);
+
+    } else {
+
+      m_weights[id] += weight;
+
+    }
+
+  }
+
+  // Returns the number of distinct children.
+  ::std::size_t size() const { return m_weights.size(); }
+
+  // Returns the sum of weight * prob(child) over distinct children.
+  template <typename PROB>
+  double sum(PROB prob) const {
+
+    double total = 0.0;
+
+    for (AFSTable::id_type id = 0; id < m_weights.size(); ++id) {
+
+      total += m_weights[id] * prob(m_children[id]);
+
+    }
+
+    return total;
+
+  }
+
+};
+
+
+// template function definitions
+
+template <typename PROB>
+double singleton_step(AFS const& afs, PROB prob) {
+
+  if (afs.size() == 1) {
+
+    return 1.0;
+
+  }
+
+  using ::std::find_if;
+
+  auto singleton = find_if(afs.begin(), afs.end(),
+                           [](AFS::value_type p)
+                           {
+                             return p.first.singleton();
+                           });
+
+  Allele allele = singleton->first;
+
+  decltype(afs.deme()) deme = 0;
+  while (allele[deme] == 0) {
+
+    ++deme;
+
+  }
+
+  double dsize = static_cast<double>(afs.size(deme));
+
+  AFS base = afs.remove(allele).add(allele.remove(deme));
+
+  ScratchAFS other(base);
+
+  // probability of a sample excluding one of singleton alleles.
+  double val = prob(other);
+
+  for (auto a: base) {
+
+    // add a gene to previously an observed allele.
+    Allele na = a.first.add(deme);
+
+    other.apply(a.first, na);
+
+    val -= prob(other) * other[na] * na[deme] / dsize;
+
+    other.undo();
+
+  }
+
+  val *= dsize / afs[allele];
+
+  return val;
+
+}
+
+
+template <typename HIT, typename PROB>
+double coalescence_step(AFS const& afs, AlleleExitCache& alleles,
+                        HIT const& hit, PROB prob) {
+
+  ChildWeights weights;
+
+  // Exits are visited one at a time rather than collected first.
+  afs.reacheable([&](AFS const& exit, State const& state)
+                 {
+                   exit_terms(exit, state.id(),
+                              [&](ScratchAFS const& child, Index id, Index deme,
+                                  double coef)
+                              {
+                                weights.add(child, coef * hit.get(id, deme));
+                              });
+                 },
+                 alleles);
+
+  return weights.sum(prob);
+
+}
+
+
+template <typename TERM>
+void singleton_terms(AFS const& afs, TERM term) {
+
+  if (afs.size() == 1) {
+
+    return;
+
+  }
+
+  using ::std::find_if;
+
+  auto singleton = find_if(afs.begin(), afs.end(),
+                           [](AFS::value_type p)
+                           {
+                             return p.first.singleton();
+                           });
+
+  Allele allele = singleton->first;
+
+  decltype(afs.deme()) deme = 0;
+  while (allele[deme] == 0) {
+
+    ++deme;
+
+  }
+
+  double dsize = static_cast<double>(afs.size(deme));
+
+  double scale = dsize / afs[allele];
+
+  AFS base = afs.remove(allele).add(allele.remove(deme));
+
+  ScratchAFS other(base);
+
+  term(other, scale);
+
+  for (auto a: base) {
+
+    Allele na = a.first.add(deme);
+
+    other.apply(a.first, na);
+
+    term(other, -scale * other[na] * na[deme] / dsize);
+
+    other.undo();
+
+  }
+
+}
+
+
+template <typename TERM>
+void coalescence_terms(AFS const& afs, AlleleExitCache& alleles,
+                       TERM term) {
+
+  afs.reacheable([&](AFS const& exit, State const& state)
+                 {
+                   exit_terms(exit, state.id(),
+                              [&](ScratchAFS const& child, Index, Index deme,
+                                  double coef)
+                              {
+                                term(child, state, deme, coef);
+                              });
+                 },
+                 alleles);
+
+}
+
+
+template <typename TERM>
+void exit_terms(AFS const& exit, Index state, TERM term) {
+
+  auto deme = exit.deme();
+
+  ScratchAFS other(exit);
+
+  for (auto a: exit) {
+
+    auto allele = a.first;
+
+    for (Index i = 0; i < deme; ++i) {
+
+      if (allele[i] > 1) {
+
+        Allele na = allele.remove(i);
+
+        other.apply(allele, na);
+
+        // The coefficient is an integer quotient.
+        auto coef = na.size() * other[na] / other.size();
+
+        if (coef != 0) {
+
+          term(other, state, i, static_cast<double>(coef));
+
+        }
+
+        other.undo();
+
+      }
+
+    }
+
+  }
+
+}
+
+
+}
+
+
+#endif // ESF_MULTI_ESF_STEP_HH
@@ -0,0 +1,125 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_store.cc - Persistent store of ESF probabilities
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "afs.hh"
+#include "esf_store.hh"
+#include "hit_prob.hh"
+#include "record_store.hh"
+
+namespace esf {
+
+
+namespace {
+
+
+char const esf_store_magic[8] = {'E', 'S', 'F', 'S', 'T', 'O', 'R', 'E'};
+
+
+::std::vector<::std::uint32_t> encode(SolverOption const& option, AFS const& afs) {
+
+  ::std::vector<::std::uint32_t> codes;
+
+  ::std::uint64_t tolerance;
+
+  ::std::memcpy(&tolerance, &option.tolerance, sizeof(tolerance));
+
+  codes.push_back(static_cast<::std::uint32_t>(option.type));
+  codes.push_back(static_cast<::std::uint32_t>(tolerance));
+  codes.push_back(static_cast<::std::uint32_t>(tolerance >> 32));
+
+  codes.push_back(static_cast<::std::uint32_t>(afs.deme()));
+
+  for (auto const& elem: afs) {
+
+    for (Index d = 0; d < afs.deme(); ++d) {
+
+      codes.push_back(static_cast<::std::uint32_t>(elem.first[d]));
+
+    }
+
+    codes.push_back(static_cast<::std::uint32_t>(elem.second));
+
+  }
+
+  return codes;
+
+}
+
+
+}
+
+
+ESFStore::ESFStore(::std::string const& path, ::std::size_t batch)
+    : m_records(path, esf_store_magic, batch) {}
+
+
+bool ESFStore::find(::std::uint64_t fingerprint, SolverOption const& option,
+                    AFS const& afs, double& value) const {
+
+  ::std::size_t count;
+
+  auto found = m_records.find(fingerprint, encode(option, afs), count);
+
+  if (!found || count != 1) {
+
+    return false;
+
+  }
+
+  ::std::memcpy(&value, found, sizeof(value));
+
+  return true;
+
+}
+
+
+void ESFStore::insert(::std::uint64_t fingerprint, SolverOption const& option,
+                      AFS const& afs, double value) {
+
+  m_records.insert(fingerprint, encode(option, afs), &value, 1);
+
+}
+
+
+void ESFStore::flush() {
+
+  m_records.flush();
+
+}
+
+
+::std::size_t ESFStore::size() const {
+
+  return m_records.size();
+
+}
+
+
+}
@@ -0,0 +1,85 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_store.hh - Persistent store of ESF probabilities
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_ESF_STORE_HH
+#define ESF_MULTI_ESF_STORE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "afs.hh"
+#include "hit_prob.hh"
+#include "record_store.hh"
+
+namespace esf {
+
+
+// This class keeps probabilities of samples on disk across runs.  A
+// probability is keyed by the fingerprint of parameters (see
+// Param::fingerprint()), the solver and its tolerance, with which
+// hitting probabilities are computed, and the canonical encoding of
+// the sample: the number of demes, followed by counts of genes and the
+// multiplicity of each allele in order.  Records are kept by
+// RecordStore.
+//
+// A store is used by one thread and written by one process at a time.
+class ESFStore {
+
+ private:
+
+  RecordStore m_records;
+
+ public:
+
+  // Opens the store at the path, creating it if it does not exist.
+  // The index is written to the path followed by ".idx".  Records are
+  // written every specified number of insertions.  Throws
+  // std::runtime_error if files cannot be read or written, or if they
+  // are not a store.
+  explicit ESFStore(::std::string const&, ::std::size_t = 4096);
+
+  // Looks up the probability of a sample under parameters of the
+  // fingerprint and solver options.  Returns whether it is found.
+  bool find(::std::uint64_t, SolverOption const&, AFS const&, double&) const;
+
+  // Stores the probability of a sample under parameters of the
+  // fingerprint and solver options, unless it is already stored.
+  void insert(::std::uint64_t, SolverOption const&, AFS const&, double);
+
+  // Writes records held in memory, and rewrites the index.  Records
+  // are otherwise written in batches, and the index on destruction.
+  void flush();
+
+  // Returns the number of records.
+  ::std::size_t size() const;
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_ESF_STORE_HH
@@ -0,0 +1,63 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// generator.cc - Infinitesimal generator of the migration process
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "generator.hh"
+#include "hit_prob_structure.hh"
+#include "init.hh"
+#include "param.hh"
+
+namespace esf {
+
+
+Generator assemble_generator(Init const& init, Param const& param,
+                             ::std::vector<double>& coals) {
+
+  HitProbStructure structure(init);
+
+  auto dim = init.dim();
+
+  auto ndeme = init.deme();
+
+  coals.clear();
+  coals.reserve(unsign(ndeme * dim));
+
+  for (decltype(dim) i = 0; i < dim; ++i) {
+
+    for (decltype(ndeme) deme = 0; deme < ndeme; ++deme) {
+
+      coals.push_back(structure.coal(i, deme));
+
+    }
+
+  }
+
+  return structure.fill(param);
+
+}
+
+
+}
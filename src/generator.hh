@@ -0,0 +1,60 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// generator.hh - Infinitesimal generator of the migration process
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_GENERATOR_HH
+#define ESF_MULTI_GENERATOR_HH
+
+#include <vector>
+
+#include <Eigen/SparseCore>
+
+#include "init.hh"
+#include "param.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+typedef ::Eigen::SparseMatrix<double, ::Eigen::ColMajor, Index> Generator;
+
+
+// Assembles the generator of the process started from an initial
+// condition.  Column i holds the rates of leaving i-th state, and the
+// diagonal includes the rates of coalescence and mutation.  The
+// number of coalescing pairs of each state and deme is written to the
+// last argument in the order of {c_00, c_01,..., c_10,...}.
+//
+// The number of non-zero elements is counted before columns are filled
+// in order, so the compressed storage is allocated and written once.
+// Memory used during assembly is therefore proportional to the
+// number of non-zero elements rather than to the square of the number
+// of states.
+Generator assemble_generator(Init const&, Param const&, ::std::vector<double>&);
+
+
+}
+
+
+#endif // ESF_MULTI_GENERATOR_HH
@@ -0,0 +1,301 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// generator_operator.cc - Matrix-free generator of the migration process
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "generator_operator.hh"
+#include "init.hh"
+#include "neighbor_table.hh"
+#include "param.hh"
+#include "state_cursor.hh"
+#include "state_space.hh"
+#include "thread_pool.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+GeneratorOperator::GeneratorOperator(Init const& init, Param const& param,
+                                     ThreadPool& pool)
+    : m_table(StateSpace(init)), m_deme(init.deme()), m_dim(init.dim()),
+      m_rate(unsign(m_table.moves())), m_pool(pool) {
+
+  // Chunks are large enough to amortize scheduling, and there are
+  // several of them per thread to balance load.
+  m_chunk = ::std::max<Index>(1024, m_dim / (8 * m_pool.size()));
+
+  for (decltype(m_rate.size()) k = 0; k < m_rate.size(); ++k) {
+
+    m_rate[k] = m_table.back_rate(sign(k), param);
+
+  }
+
+  set_diagonal(param);
+
+}
+
+
+Index GeneratorOperator::dim() const {
+
+  return m_dim;
+
+}
+
+
+GeneratorOperator::vector_type const& GeneratorOperator::diagonal() const {
+
+  return m_diag;
+
+}
+
+
+double GeneratorOperator::coal(Index idx, Index deme) const {
+
+  auto const& space = m_table.space();
+
+  Index genes = 0;
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    auto rank = idx / space.stride(b) % m_table.size(b);
+
+    genes += m_table.composition(b, rank)[deme];
+
+  }
+
+  Index choice = 2;
+
+  return binomial(genes, choice);
+
+}
+
+
+void GeneratorOperator::apply(vector_type const& x, vector_type& y) const {
+
+  y.resize(m_dim);
+
+  m_pool.parallel_for(
+      0, m_dim, m_chunk,
+      [this, &x, &y](Index lo, Index hi)
+      {
+        StateCursor cursor(m_table.space(), lo);
+
+        for (auto j = lo; j < hi; ++j, ++cursor) {
+
+          double acc = m_diag(j) * x(j);
+
+          m_table.for_each(j, cursor.ranks(), [this, &x, &acc](Move const& move) {
+
+              acc += m_rate[unsign(move.index)] * x(move.id);
+
+            });
+
+          y(j) = acc;
+
+        }
+      });
+
+}
+
+
+void GeneratorOperator::set_diagonal(Param const& param) {
+
+  using ::std::vector;
+
+  // Total rate of leaving each composition of each origin by migration.
+  vector<vector<double>> out(unsign(m_deme));
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    auto& rates = out[unsign(b)];
+
+    rates.assign(unsign(m_table.size(b)), 0.0);
+
+    for (decltype(rates.size()) r = 0; r < rates.size(); ++r) {
+
+      auto comp = m_table.composition(b, sign(r));
+
+      for (decltype(m_deme) p = 0; p < m_deme; ++p) {
+
+        for (decltype(m_deme) q = 0; q < m_deme; ++q) {
+
+          if (p != q) {
+
+            rates[r] += comp[p] * param.mig_rate(p, q);
+
+          }
+
+        }
+
+      }
+
+    }
+
+  }
+
+  m_diag.resize(m_dim);
+
+  m_pool.parallel_for(
+      0, m_dim, m_chunk,
+      [this, &out, &param](Index lo, Index hi)
+      {
+        StateCursor cursor(m_table.space(), lo);
+
+        for (auto j = lo; j < hi; ++j, ++cursor) {
+
+          double total = 0.0;
+
+          for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+            total += out[unsign(b)][unsign(cursor.rank(b))];
+
+          }
+
+          for (decltype(m_deme) p = 0; p < m_deme; ++p) {
+
+            Index choice = 2;
+            auto g = cursor.genes(p);
+            total += 2.0 * binomial(g, choice) * param.pop_size(p) + g * param.mut_rate(p);
+
+          }
+
+          m_diag(j) = -total;
+
+        }
+      });
+
+}
+
+
+bool solve(GeneratorOperator const& op, GeneratorOperator::vector_type const& b,
+           GeneratorOperator::vector_type& x, double tolerance,
+           Index max_iterations, Index& iterations, double& error) {
+
+  typedef GeneratorOperator::vector_type vector_type;
+
+  auto dim = op.dim();
+
+  if (max_iterations <= 0) {
+
+    max_iterations = 2 * dim;
+
+  }
+
+  vector_type const& diag = op.diagonal();
+
+  double b_norm2 = b.squaredNorm();
+
+  iterations = 0;
+  error = 0.0;
+
+  x = vector_type::Zero(dim);
+
+  if (b_norm2 == 0.0) {
+
+    return true;
+
+  }
+
+  double threshold = tolerance * tolerance * b_norm2;
+
+  vector_type r = b, r0 = b;
+  vector_type v = vector_type::Zero(dim), p = vector_type::Zero(dim);
+  vector_type y(dim), z(dim), s(dim), t(dim);
+
+  double rho = 1.0, alpha = 1.0, w = 1.0;
+
+  double r_norm2 = b_norm2;
+
+  while (r_norm2 > threshold && iterations < max_iterations) {
+
+    double rho_old = rho;
+
+    rho = r0.dot(r);
+
+    if (rho == 0.0) {
+
+      // The residual became orthogonal to the shadow residual, and
+      // iteration restarts from the current residual as from the first
+      // step.
+      r0 = r;
+      rho = r_norm2;
+
+      p = r;
+      v.setZero();
+
+      alpha = 1.0;
+      w = 1.0;
+
+    } else {
+
+      double beta = (rho / rho_old) * (alpha / w);
+
+      p = r + beta * (p - w * v);
+
+    }
+
+    y = p.cwiseQuotient(diag);
+
+    op.apply(y, v);
+
+    alpha = rho / r0.dot(v);
+
+    s = r - alpha * v;
+
+    z = s.cwiseQuotient(diag);
+
+    op.apply(z, t);
+
+    double t_norm2 = t.squaredNorm();
+
+    w = t_norm2 > 0.0 ? t.dot(s) / t_norm2 : 0.0;
+
+    x += alpha * y + w * z;
+
+    r = s - w * t;
+
+    r_norm2 = r.squaredNorm();
+
+    ++iterations;
+
+    // The solver stalls if it cannot make any progress.
+    if (w == 0.0 || !::std::isfinite(r_norm2)) {
+
+      break;
+
+    }
+
+  }
+
+  error = ::std::sqrt(r_norm2 / b_norm2);
+
+  return r_norm2 <= threshold;
+
+}
+
+
+}
@@ -0,0 +1,116 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// generator_operator.hh - Matrix-free generator of the migration process
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef ESF_MULTI_GENERATOR_OPERATOR_HH
+#define ESF_MULTI_GENERATOR_OPERATOR_HH
+
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "init.hh"
+#include "neighbor_table.hh"
+#include "param.hh"
+#include "thread_pool.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class applies the generator to a vector without storing the
+// generator as a matrix.
+//
+// Neighbors of a state are enumerated by NeighborTable, which
+// tabulates migrations per composition of each deme of origin.  A
+// migration is reversible, so states, from which a state is entered,
+// are its neighbors, and the rates of entering are tabulated once per
+// migration of the table.  Memory then grows with the number of states
+// instead of the number of non-zero elements.
+//
+// Rows of the product are computed independently, and they are
+// distributed over threads of the pool.
+class GeneratorOperator {
+
+ public:
+
+  typedef ::Eigen::Matrix<double, ::Eigen::Dynamic, 1> vector_type;
+
+ private:
+
+  NeighborTable m_table;
+
+  Index m_deme;
+
+  Index m_dim;
+
+  // The rate, at which the neighbor reached by each migration of the
+  // table moves back to the state.
+  ::std::vector<double> m_rate;
+
+  vector_type m_diag;
+
+  ThreadPool& m_pool;
+
+  Index m_chunk;
+
+  void set_diagonal(Param const&);
+
+ public:
+
+  GeneratorOperator(Init const&, Param const&, ThreadPool&);
+
+  GeneratorOperator(GeneratorOperator const&) = delete;
+
+  GeneratorOperator& operator=(GeneratorOperator const&) = delete;
+
+  ~GeneratorOperator() = default;
+
+  // Returns the number of states.
+  Index dim() const;
+
+  // Returns the diagonal of the generator.
+  vector_type const& diagonal() const;
+
+  // Returns the number of pairs of genes, which can coalesce in a
+  // specified deme of i-th state.
+  double coal(Index, Index) const;
+
+  // Computes y = U x for U the generator.
+  void apply(vector_type const&, vector_type&) const;
+
+};
+
+
+// Solves U x = b by BiCGSTAB preconditioned with the diagonal of the
+// generator.  Iteration stops when the residual relative to b falls
+// below the tolerance.  Returns false if the solver did not converge
+// within the maximum number of iterations.
+bool solve(GeneratorOperator const&, GeneratorOperator::vector_type const&,
+           GeneratorOperator::vector_type&, double, Index, Index&, double&);
+
+
+}
+
+
+#endif // ESF_MULTI_GENERATOR_OPERATOR_HH
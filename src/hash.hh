@@ -0,0 +1,155 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hash.hh - Hash functions and diagnostics of hash tables
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_HASH_HH
+#define ESF_MULTI_HASH_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace esf {
+
+
+// Scrambles bits of a 64 bit integer.  This is the finalizer of
+// splitmix64, and every bit of the input affects every bit of the
+// output.
+inline ::std::uint64_t hash_mix(::std::uint64_t x) {
+
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+
+  return x;
+
+}
+
+
+// Folds a value into a running hash.  The result depends on the order
+// of values, so a sequence of values is hashed by folding them one by
+// one starting from a seed.
+inline ::std::uint64_t hash_combine(::std::uint64_t seed,
+                                    ::std::uint64_t value) {
+
+  seed ^= hash_mix(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+
+  return hash_mix(seed);
+
+}
+
+
+// Summary of how keys of a hash table are spread over buckets.
+struct HashDiagnostics {
+
+  ::std::size_t keys;
+
+  ::std::size_t buckets;
+
+  // Number of buckets holding exactly i keys at index i.
+  ::std::vector<::std::size_t> bucket_lengths;
+
+  // Fraction of keys sharing a bucket with another key.
+  double bucket_collision_rate;
+
+  // Fraction of keys whose full hash equals that of an earlier key.
+  double hash_collision_rate;
+
+  // Average number of keys visited by a successful lookup.
+  double mean_probe;
+
+};
+
+
+// Computes diagnostics of an unordered associative container.
+template <typename TABLE>
+HashDiagnostics diagnose(TABLE const&);
+
+
+// template function definitions
+
+template <typename TABLE>
+HashDiagnostics diagnose(TABLE const& table) {
+
+  using ::std::size_t;
+
+  HashDiagnostics diag;
+
+  diag.keys = table.size();
+  diag.buckets = table.bucket_count();
+
+  size_t shared = 0, probes = 0;
+
+  for (size_t b = 0; b < table.bucket_count(); ++b) {
+
+    auto len = table.bucket_size(b);
+
+    if (diag.bucket_lengths.size() <= len) {
+
+      diag.bucket_lengths.resize(len + 1, 0);
+
+    }
+
+    ++diag.bucket_lengths[len];
+
+    if (len > 1) {
+
+      shared += len;
+
+    }
+
+    // The i-th key of a chain is found after visiting i keys.
+    probes += len * (len + 1) / 2;
+
+  }
+
+  ::std::unordered_set<size_t> hashes;
+
+  auto hasher = table.hash_function();
+
+  for (auto const& entry: table) {
+
+    hashes.insert(hasher(entry.first));
+
+  }
+
+  auto keys = static_cast<double>(::std::max<size_t>(1, diag.keys));
+
+  diag.bucket_collision_rate = shared / keys;
+  diag.hash_collision_rate = (diag.keys - hashes.size()) / keys;
+  diag.mean_probe = probes / keys;
+
+  return diag;
+
+}
+
+
+}
+
+
+#endif // ESF_MULTI_HASH_HH
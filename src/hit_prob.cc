@@ -26,29 +26,84 @@
 #include <algorithm>
 #include <iterator>
 #include <numeric>
+#include <stdexcept>
 
+#include <Eigen/Dense>
+#include <Eigen/IterativeLinearSolvers>
 #include <Eigen/SparseCore>
 #include <Eigen/SparseLU>
-#include <Eigen/SparseLU>
+#include <unsupported/Eigen/IterativeSolvers>
 
+#include "generator_operator.hh"
 #include "hit_prob.hh"
+#include "hit_prob_structure.hh"
+#include "neighbor_table.hh"
 #include "param.hh"
 #include "state.hh"
+#include "state_cursor.hh"
+#include "state_space.hh"
+#include "thread_pool.hh"
 #include "util.hh"
 
 namespace esf {
 
 using ::std::accumulate;
 
-using Matrix = Eigen::SparseMatrix<double, Eigen::ColMajor, Index>;
-using Vector = Eigen::SparseVector<double, Eigen::ColMajor, Index>;
-using Solver = Eigen::SparseLU<Matrix>;
-using VectorXi = Eigen::Matrix<Index, Eigen::Dynamic, 1>;
 using VectorXd = Eigen::Matrix<double, Eigen::Dynamic, 1>;
 
+// The index type of ILUT needs to match that of the generator, and it
+// is only configurable since Eigen 3.3.
+#if EIGEN_VERSION_AT_LEAST(3, 3, 0)
+using Preconditioner = Eigen::IncompleteLUT<double, Index>;
+#else
+using Preconditioner = Eigen::IncompleteLUT<double>;
+#endif
+
+
+namespace {
+
+
+// Solves the system with an iterative solver.  Returns false if the
+// solver failed to converge.
+template <typename SOLVER>
+bool solve_iteratively(Generator const&, VectorXd const&, SolverOption const&,
+                       VectorXd&, Index&, double&);
+
+
+// Sets the generator as a dense matrix, and the number of coalescing
+// pairs of genes in each deme of every state as in
+// assemble_generator.  Elements are written directly from neighbors of
+// states without a sparse matrix in between.
+void fill_dense(NeighborTable const&, Param const&, Eigen::MatrixXd&,
+                vector<double>&);
+
+
+// Converts the solution into hitting probabilities.  The number of
+// coalescing pairs is taken from the last argument.
+template <typename COAL>
+void set_prob(vector<double>&, VectorXd const&, Param const&, Index, COAL const&);
+
+
+}
+
+
+HitProb::HitProb()
+    : m_solver(SolverType::SparseLU), m_iterations(0), m_error(0.0) {}
+
+
+HitProb::HitProb(Init const& i, Param const& p, SolverOption const& o)
+    : m_init(i), m_param(p), m_option(o) {
+
+  m_prob.reserve(unsign(m_init.dim() * m_init.deme()));
+
+  compute();
+
+}
+
 
-HitProb::HitProb(Init const& i, Param const& p)
-    : m_init(i), m_param(p) {
+HitProb::HitProb(::std::shared_ptr<HitProbStructure> const& s, Param const& p,
+                 SolverOption const& o)
+    : m_init(s->init()), m_param(p), m_option(o), m_structure(s) {
 
   m_prob.reserve(unsign(m_init.dim() * m_init.deme()));
 
@@ -57,6 +112,20 @@ HitProb::HitProb(Init const& i, Param const& p)
 }
 
 
+HitProb::HitProb(Init const& i, Param const& p, SolverOption const& o,
+                 vector<double> const& prob)
+    : m_init(i), m_param(p), m_option(o), m_prob(prob),
+      m_solver(o.type), m_iterations(0), m_error(0.0) {
+
+  if (m_prob.size() != unsign(m_init.dim() * m_init.deme())) {
+
+    throw ::std::invalid_argument("number of hitting probabilities does not match states");
+
+  }
+
+}
+
+
 double HitProb::get(Index idx,
                     Index deme) const {
 
@@ -72,105 +141,329 @@ double HitProb::get(State const& state, Index deme) const {
 }
 
 
+Init const& HitProb::init() const {
+
+  return m_init;
+
+}
+
+
+Param const& HitProb::param() const {
+
+  return m_param;
+
+}
+
+
+SolverOption const& HitProb::option() const {
+
+  return m_option;
+
+}
+
+
+vector<double> const& HitProb::values() const {
+
+  return m_prob;
+
+}
+
+
 HitProb HitProb::update(Param const& p) const {
 
-  return HitProb(m_init, p);
+  HitProb hit_prob;
+
+  hit_prob.m_init = m_init;
+  hit_prob.m_param = p;
+  hit_prob.m_option = m_option;
+  hit_prob.m_structure = m_structure;
+  hit_prob.m_table = m_table;
+  hit_prob.m_pool = m_pool;
+
+  hit_prob.m_prob.reserve(unsign(m_init.dim() * m_init.deme()));
+
+  hit_prob.compute();
+
+  return hit_prob;
+
+}
+
+
+HitProb HitProb::update(Param const& p, vector<double> const& prob) const {
+
+  HitProb hit_prob(m_init, p, m_option, prob);
+
+  hit_prob.m_structure = m_structure;
+  hit_prob.m_table = m_table;
+  hit_prob.m_pool = m_pool;
+
+  return hit_prob;
+
+}
+
+
+SolverType HitProb::solver() const {
+
+  return m_solver;
+
+}
+
+
+Index HitProb::iterations() const {
+
+  return m_iterations;
+
+}
+
+
+double HitProb::error() const {
+
+  return m_error;
 
 }
 
 
-// Because Eigen only handles
 void HitProb::compute() {
 
   auto dim = m_init.dim();
 
-  Matrix u(dim, dim);
+  VectorXd a = VectorXd::Zero(dim);
+  a(State(m_init).id()) = 1.0;
 
-  auto ndeme = m_init.deme();
+  VectorXd x;
 
-  u.reserve(VectorXi::Constant(dim, (2 * ndeme * (ndeme - 1) + 1) * dim));
+  bool converged = false;
 
-  vector<double> coals;
-  coals.reserve(unsign(ndeme * dim));
+  m_solver = m_option.type;
+  m_iterations = 0;
+  m_error = 0.0;
 
-  for (decltype(dim) i = 0; i < dim; ++i) {
+  if (m_option.type == SolverType::MatrixFree) {
 
-    State s(m_init, i);
+    if (!m_pool) {
 
-    Init ii(s);
+      m_pool = ::std::make_shared<ThreadPool>(m_option.threads);
 
-    double total = 0.0;
+    }
 
-    for (auto adj: s.neighbors()) {
+    GeneratorOperator op(m_init, m_param, *m_pool);
 
-      double u_val = compute_u(s, adj);
-      u.insert(adj.id(), i) = u_val;
+    converged = solve(op, a, x, m_option.tolerance, m_option.max_iterations,
+                      m_iterations, m_error);
 
-      total += u_val;
+    if (converged) {
+
+      set_prob(m_prob, x, m_param, m_init.deme(),
+               [&op](Index i, Index j) { return op.coal(i, j); });
+
+      return;
 
     }
 
-    for (decltype(ndeme) deme = 0; deme < ndeme; ++deme) {
+  }
 
-      Index choice = 2;
-      auto coal = binomial(ii[deme], choice);
-      total += 2.0 * coal * m_param.pop_size(deme) + ii[deme] * m_param.mut_rate(deme);
+  switch (m_option.type) {
 
-      coals.push_back(coal);
+    case SolverType::BiCGSTAB:
 
-    }
+      converged = solve_iteratively<Eigen::BiCGSTAB<Generator, Preconditioner>>(
+          structure().fill(m_param), a, m_option, x, m_iterations, m_error);
+
+      break;
+
+    case SolverType::GMRES:
 
-    u.insert(i, i) = -total;
+      converged = solve_iteratively<Eigen::GMRES<Generator, Preconditioner>>(
+          structure().fill(m_param), a, m_option, x, m_iterations, m_error);
+
+      break;
+
+    case SolverType::SparseLU:
+    case SolverType::DenseLU:
+    case SolverType::MatrixFree:
+
+      break;
 
   }
 
-  u.makeCompressed();
+  if (!converged && (m_option.type == SolverType::DenseLU ||
+                     dim <= m_option.dense_threshold)) {
 
-  Vector a(dim);
-  a.insert(State(m_init).id()) = 1.0;
+    m_solver = SolverType::DenseLU;
 
-  Solver solver(u);
-  if (solver.info() != Eigen::Success) {
+    Eigen::MatrixXd u;
+
+    vector<double> coals;
+
+    if (!m_table) {
+
+      m_table = ::std::make_shared<NeighborTable>(StateSpace(m_init));
+
+    }
+
+    fill_dense(*m_table, m_param, u, coals);
+
+    x = u.partialPivLu().solve(a);
+
+    auto ndeme = m_init.deme();
+
+    set_prob(m_prob, x, m_param, ndeme,
+             [&coals, ndeme](Index i, Index j) { return coals[unsign(i * ndeme + j)]; });
 
     return;
 
   }
 
-  VectorXd x = -solver.solve(a);
+  if (!converged) {
+
+    m_solver = SolverType::SparseLU;
+
+    auto& solver = structure().factorize(m_param);
+    if (solver.info() != Eigen::Success) {
+
+      return;
+
+    }
+
+    x = solver.solve(a);
+    if (solver.info() != Eigen::Success) {
+
+      return;
+
+    }
+
+  }
+
+  auto s = &structure();
+
+  set_prob(m_prob, x, m_param, m_init.deme(),
+           [s](Index i, Index j) { return s->coal(i, j); });
+
+}
+
+
+HitProbStructure& HitProb::structure() {
+
+  if (!m_structure) {
+
+    m_structure = ::std::make_shared<HitProbStructure>(m_init);
+
+  }
+
+  return *m_structure;
+
+}
+
+
+namespace {
+
+
+template <typename SOLVER>
+bool solve_iteratively(Generator const& u, VectorXd const& a,
+                       SolverOption const& option,
+                       VectorXd& x, Index& iterations, double& error) {
+
+  SOLVER solver;
+
+  // The default drop tolerance of ILUT keeps almost every fill-in, and
+  // computing the preconditioner then costs more than the direct
+  // solver.  The generator is diagonally dominant, so a coarse
+  // factorization is enough.
+  solver.preconditioner().setDroptol(1.0e-3);
+  solver.preconditioner().setFillfactor(5);
+
+  solver.setTolerance(option.tolerance);
+
+  if (option.max_iterations > 0) {
+
+    solver.setMaxIterations(option.max_iterations);
+
+  }
+
+  solver.compute(u);
   if (solver.info() != Eigen::Success) {
 
-    return;
+    return false;
 
   }
 
-  for (decltype(dim) i = 0; i < dim; ++i) {
+  x = solver.solve(a);
 
-    for (decltype(ndeme) j = 0; j < ndeme; ++j) {
+  iterations = solver.iterations();
+  error = solver.error();
+
+  return solver.info() == Eigen::Success;
+
+}
+
+
+void fill_dense(NeighborTable const& table, Param const& param,
+                Eigen::MatrixXd& u, vector<double>& coals) {
+
+  auto const& space = table.space();
+
+  auto dim = space.dim();
+
+  auto ndeme = space.deme();
+
+  u.setZero(dim, dim);
+
+  coals.clear();
+  coals.reserve(unsign(dim * ndeme));
+
+  for (StateCursor cursor(space); !cursor.done(); ++cursor) {
+
+    auto i = cursor.id();
+
+    double total = 0.0;
 
-      m_prob.push_back(x(i) * 2.0 * m_param.pop_size(j) * coals[unsign(i * ndeme + j)]);
+    table.for_each(i, cursor.ranks(), [&](Move const& move) {
+
+        double rate = table.rate(move, param);
+
+        u(move.id, i) = rate;
+
+        total += rate;
+
+      });
+
+    for (decltype(ndeme) deme = 0; deme < ndeme; ++deme) {
+
+      Index genes = cursor.genes(deme), choice = 2;
+
+      double coal = binomial(genes, choice);
+
+      coals.push_back(coal);
+
+      total += 2.0 * coal * param.pop_size(deme) + genes * param.mut_rate(deme);
 
     }
 
+    u(i, i) = -total;
+
   }
 
 }
 
 
-double HitProb::compute_u(State const& from, State const& to) const {
+template <typename COAL>
+void set_prob(vector<double>& prob, VectorXd const& x, Param const& param,
+              Index ndeme, COAL const& coal) {
 
-  Index size = m_init.deme();
+  auto dim = x.size();
 
-  Index i = 0;
-  while (from[i] != to[i] + 1) {
-    ++i;
-  }
+  for (decltype(dim) i = 0; i < dim; ++i) {
+
+    for (decltype(ndeme) j = 0; j < ndeme; ++j) {
+
+      prob.push_back(-x(i) * 2.0 * param.pop_size(j) * coal(i, j));
+
+    }
 
-  Index j = i / size * size;
-  while (from[j] != to[j] - 1) {
-    ++j;
   }
 
-  return from[i] * m_param.mig_rate(i % size, j % size);
+}
+
 
 }
 
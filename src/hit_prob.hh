@@ -26,6 +26,7 @@
 #ifndef ESF_MULTI_HIT_PROB_HH
 #define ESF_MULTI_HIT_PROB_HH
 
+#include <memory>
 #include <vector>
 
 #include "init.hh"
@@ -38,8 +39,56 @@ using ::std::vector;
 
 
 // Forward declaration
+class HitProbStructure;
 class Init;
+class NeighborTable;
 class State;
+class ThreadPool;
+
+
+// Linear solvers for computing hitting probabilities.  SparseLU and
+// DenseLU are direct, and BiCGSTAB and GMRES are iterative solvers
+// preconditioned by incomplete LU factorization with threshold
+// (ILUT).  Iterative solvers need much less memory for large state
+// spaces.  MatrixFree is BiCGSTAB working directly on the structure of
+// states without building the generator, and it runs on multiple
+// threads.
+enum class SolverType { SparseLU, DenseLU, BiCGSTAB, GMRES, MatrixFree };
+
+
+// Options passed to the linear solver.  The tolerance and the maximum
+// number of iterations are used only by iterative solvers.  If an
+// iterative solver fails to converge, computation falls back to a
+// direct solver.  The maximum number of iterations of zero means the
+// default of the solver, which is twice the number of states.  The
+// number of threads is used by the matrix-free solver, and zero means
+// the number of hardware threads.
+//
+// SparseLU is replaced by DenseLU if the number of states does not
+// exceed the dense threshold.  For such small systems, a dense
+// factorization is faster than setting up a sparse one.  The default
+// threshold is taken from bench/dense_lu_bench.
+struct SolverOption {
+
+  SolverType type;
+
+  double tolerance;
+
+  Index max_iterations;
+
+  Index threads;
+
+  Index dense_threshold;
+
+  SolverOption(SolverType t = SolverType::SparseLU,
+               double tol = 1.0e-12,
+               Index max_iter = 0,
+               Index nthreads = 0,
+               Index dense = 200)
+      : type(t), tolerance(tol), max_iterations(max_iter), threads(nthreads),
+        dense_threshold(dense) {}
+
+};
 
 
 // This class computes the probabilities of coalescence given initial
@@ -59,15 +108,35 @@ class HitProb {
 
   Param m_param;
 
+  SolverOption m_option;
+
+  ::std::shared_ptr<HitProbStructure> m_structure;
+
+  // Neighbors of states, from which the dense generator is filled.
+  // They are built at the first dense solve, and they are shared with
+  // objects made by update() as the structure is.
+  ::std::shared_ptr<NeighborTable> m_table;
+
+  // Threads of the matrix-free solver are started at the first solve,
+  // and they are shared with objects made by update().
+  ::std::shared_ptr<ThreadPool> m_pool;
+
   vector<double> m_prob;
 
+  SolverType m_solver;
+
+  Index m_iterations;
+
+  double m_error;
+
   void compute();
 
-  double compute_u(State const&, State const&) const;
+  // Returns the structure, which is built at the first call.
+  HitProbStructure& structure();
 
  public:
 
-  HitProb() = default;
+  HitProb();
 
   HitProb(HitProb const&) = default;
 
@@ -81,7 +150,23 @@ class HitProb {
 
   // The hittng probabilities are computated upon construction of
   // HitProb object.
-  HitProb(Init const&, Param const&);
+  HitProb(Init const&, Param const&,
+          SolverOption const& = SolverOption());
+
+  // This constructor reuses the sparsity pattern and the symbolic
+  // analysis of a previously built structure.  Only the numerical
+  // values of the generator are recomputed.  A structure is shared
+  // only explicitly, by this constructor and update(), since its
+  // matrix and solver are overwritten by every solve.
+  HitProb(::std::shared_ptr<HitProbStructure> const&, Param const&,
+          SolverOption const& = SolverOption());
+
+  // This constructor takes probabilities solved earlier for the same
+  // initial condition and parameters, such as those kept in
+  // HitProbStore, in the order of get(Index, Index).  Throws
+  // std::invalid_argument if their number does not match the states.
+  HitProb(Init const&, Param const&, SolverOption const&,
+          vector<double> const&);
 
   // Returns the hitting probability of i-th state and coalescence in
   // j-th deme. States contain information of initial and current
@@ -92,8 +177,42 @@ class HitProb {
   // Returns the hitting probability of specified state and deme.
   double get(State const&, Index) const;
 
+  Init const& init() const;
+
+  Param const& param() const;
+
+  // Returns the requested solver options.
+  SolverOption const& option() const;
+
+  // Returns all probabilities in the order of get(Index, Index).
+  vector<double> const& values() const;
+
+  // Computes the hitting probabilities with new parameters.  The
+  // structure, threads and solver options of the current object are
+  // shared with the new one, so this function must not be called
+  // concurrently on objects sharing them.
   HitProb update(Param const&) const;
 
+  // The same as above, but takes probabilities solved earlier for the
+  // new parameters, such as those kept in HitProbStore, instead of
+  // solving them.  The structure and threads are still shared, so that
+  // later updates do not build them again.  Throws
+  // std::invalid_argument if their number does not match the states.
+  HitProb update(Param const&, vector<double> const&) const;
+
+  // Returns the solver actually used.  This differs from the
+  // requested one if an iterative solver failed to converge.
+  SolverType solver() const;
+
+  // Returns the number of iterations taken by an iterative solver.
+  // This is zero if only the direct solver is used.  After a fallback,
+  // it is the number of iterations of the failed attempt.
+  Index iterations() const;
+
+  // Returns the estimated relative error of an iterative solver in
+  // the same manner as the number of iterations.
+  double error() const;
+
 };
 
 
@@ -0,0 +1,145 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hit_prob_store.cc - Persistent store of hitting probabilities
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "hit_prob.hh"
+#include "hit_prob_store.hh"
+#include "init.hh"
+#include "param.hh"
+#include "record_store.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+namespace {
+
+
+char const hit_prob_store_magic[8] = {'E', 'S', 'F', 'H', 'I', 'T', 'P', 'R'};
+
+
+::std::vector<::std::uint32_t> encode(SolverOption const& option, Init const& init) {
+
+  ::std::vector<::std::uint32_t> codes;
+
+  ::std::uint64_t tolerance;
+
+  ::std::memcpy(&tolerance, &option.tolerance, sizeof(tolerance));
+
+  codes.push_back(static_cast<::std::uint32_t>(option.type));
+  codes.push_back(static_cast<::std::uint32_t>(tolerance));
+  codes.push_back(static_cast<::std::uint32_t>(tolerance >> 32));
+
+  codes.push_back(static_cast<::std::uint32_t>(init.deme()));
+
+  for (auto i: init) {
+
+    codes.push_back(static_cast<::std::uint32_t>(i));
+
+  }
+
+  return codes;
+
+}
+
+
+}
+
+
+HitProbStore::HitProbStore(::std::string const& path, ::std::size_t batch)
+    : m_records(path, hit_prob_store_magic, batch) {}
+
+
+bool HitProbStore::find(Init const& init, Param const& param,
+                        SolverOption const& option, HitProb& hit_prob) const {
+
+  ::std::size_t count;
+
+  auto found = m_records.find(param.fingerprint(), encode(option, init), count);
+
+  if (!found || count != unsign(init.dim() * init.deme())) {
+
+    return false;
+
+  }
+
+  ::std::vector<double> prob(count);
+
+  ::std::memcpy(prob.data(), found, count * sizeof(double));
+
+  hit_prob = HitProb(init, param, option, prob);
+
+  return true;
+
+}
+
+
+void HitProbStore::insert(HitProb const& hit_prob) {
+
+  auto const& values = hit_prob.values();
+
+  m_records.insert(hit_prob.param().fingerprint(), encode(hit_prob.option(), hit_prob.init()),
+                   values.data(), values.size());
+
+}
+
+
+HitProb HitProbStore::get_or_compute(Init const& init, Param const& param,
+                                     SolverOption const& option) {
+
+  HitProb hit_prob;
+
+  if (!find(init, param, option, hit_prob)) {
+
+    hit_prob = HitProb(init, param, option);
+
+    insert(hit_prob);
+
+  }
+
+  return hit_prob;
+
+}
+
+
+void HitProbStore::flush() {
+
+  m_records.flush();
+
+}
+
+
+::std::size_t HitProbStore::size() const {
+
+  return m_records.size();
+
+}
+
+
+}
@@ -0,0 +1,217 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hit_prob_structure.cc - Parameter-independent part of hitting probabilities
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "hit_prob_structure.hh"
+#include "init.hh"
+#include "neighbor_table.hh"
+#include "param.hh"
+#include "state.hh"
+#include "state_cursor.hh"
+#include "state_space.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+HitProbStructure::HitProbStructure(Init const& init)
+    : m_init(init), m_start(State(init).id()), m_analyzed(false) {
+
+  using ::std::tuple;
+  using ::std::vector;
+
+  auto dim = m_init.dim();
+
+  auto ndeme = m_init.deme();
+
+  m_matrix.resize(dim, dim);
+
+  StateSpace space(m_init);
+
+  NeighborTable table(space);
+
+  // Every column holds the diagonal and one element per neighbor.  The
+  // number of non-zero elements is counted first, so that the storage
+  // is allocated once.
+  Index nnz = 0;
+
+  for (StateCursor cursor(space); !cursor.done(); ++cursor) {
+
+    nnz += 1 + table.degree(cursor.ranks());
+
+  }
+
+  m_matrix.reserve(nnz);
+
+  m_move.reserve(unsign(nnz));
+  m_weight.reserve(unsign(nnz));
+
+  m_genes.reserve(unsign(ndeme * dim));
+
+  // Entries of a single column as (row, move, weight).  Eigen requires
+  // row indices within a column to be sorted before they are appended.
+  // This buffer is reused for all columns, and states are visited in
+  // order by a cursor, so the loop does not allocate memory per state.
+  vector<tuple<Index, Index, Index>> column;
+
+  for (StateCursor cursor(space); !cursor.done(); ++cursor) {
+
+    auto i = cursor.id();
+
+    column.clear();
+
+    table.for_each(i, cursor.ranks(), [&](Move const& move) {
+
+        column.emplace_back(move.id,
+                            move.src % ndeme + (move.tar % ndeme) * ndeme,
+                            move.genes);
+
+      });
+
+    column.emplace_back(i, -1, 0);
+
+    ::std::sort(column.begin(), column.end());
+
+    m_matrix.startVec(i);
+
+    for (auto const& entry: column) {
+
+      m_matrix.insertBack(::std::get<0>(entry), i) = 0.0;
+
+      m_move.push_back(::std::get<1>(entry));
+      m_weight.push_back(::std::get<2>(entry));
+
+    }
+
+    for (decltype(ndeme) deme = 0; deme < ndeme; ++deme) {
+
+      m_genes.push_back(cursor.genes(deme));
+
+    }
+
+  }
+
+  m_matrix.finalize();
+
+}
+
+
+Init const& HitProbStructure::init() const {
+
+  return m_init;
+
+}
+
+
+Index HitProbStructure::start() const {
+
+  return m_start;
+
+}
+
+
+double HitProbStructure::coal(Index idx, Index deme) const {
+
+  Index choice = 2;
+
+  return binomial(m_genes[unsign(idx * m_init.deme() + deme)], choice);
+
+}
+
+
+Generator const& HitProbStructure::fill(Param const& param) {
+
+  auto dim = m_init.dim();
+
+  auto ndeme = m_init.deme();
+
+  auto outer = m_matrix.outerIndexPtr();
+
+  auto values = m_matrix.valuePtr();
+
+  for (decltype(dim) i = 0; i < dim; ++i) {
+
+    double total = 0.0;
+
+    Index diag = outer[i];
+
+    for (auto k = outer[i]; k < outer[i + 1]; ++k) {
+
+      auto move = m_move[unsign(k)];
+
+      if (move < 0) {
+
+        diag = k;
+
+        continue;
+
+      }
+
+      double u_val = m_weight[unsign(k)] * param.mig_rate(move % ndeme, move / ndeme);
+      values[k] = u_val;
+
+      total += u_val;
+
+    }
+
+    for (decltype(ndeme) deme = 0; deme < ndeme; ++deme) {
+
+      auto genes = m_genes[unsign(i * ndeme + deme)];
+      total += 2.0 * coal(i, deme) * param.pop_size(deme) + genes * param.mut_rate(deme);
+
+    }
+
+    values[diag] = -total;
+
+  }
+
+  return m_matrix;
+
+}
+
+
+HitProbStructure::solver_type& HitProbStructure::factorize(Param const& param) {
+
+  fill(param);
+
+  if (!m_analyzed) {
+
+    m_solver.analyzePattern(m_matrix);
+
+    m_analyzed = true;
+
+  }
+
+  m_solver.factorize(m_matrix);
+
+  return m_solver;
+
+}
+
+
+}
@@ -0,0 +1,112 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hit_prob_structure.hh - Parameter-independent part of hitting probabilities
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef ESF_MULTI_HIT_PROB_STRUCTURE_HH
+#define ESF_MULTI_HIT_PROB_STRUCTURE_HH
+
+#include <vector>
+
+#include <Eigen/SparseCore>
+#include <Eigen/SparseLU>
+
+#include "generator.hh"
+#include "init.hh"
+#include "param.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class holds everything about the generator that depends only
+// on an initial condition: the sparsity pattern, the migration each
+// non-zero element corresponds to, the number of genes in each deme of
+// every state, and the symbolic analysis of the LU decomposition.  A
+// new set of parameters then only requires numerical refill of the
+// matrix followed by numerical factorization.
+//
+// The matrix and the solver are overwritten by each factorization, so
+// an object must not be shared by concurrent computations.
+class HitProbStructure {
+
+ public:
+
+  typedef ::Eigen::SparseLU<Generator> solver_type;
+
+ private:
+
+  Init m_init;
+
+  Index m_start;
+
+  Generator m_matrix;
+
+  // For each non-zero element, the migration rate it uses is encoded
+  // as src + tar * deme, and the diagonal elements are marked by -1.
+  ::std::vector<Index> m_move;
+
+  // For each non-zero element, the number of genes which can migrate.
+  ::std::vector<Index> m_weight;
+
+  // The number of genes in each deme for every state.  The order is
+  // {g_00, g_01,..., g_10,...} for g_ij i-th state and j-th deme.
+  ::std::vector<Index> m_genes;
+
+  solver_type m_solver;
+
+  bool m_analyzed;
+
+ public:
+
+  HitProbStructure(Init const&);
+
+  HitProbStructure(HitProbStructure const&) = delete;
+
+  HitProbStructure& operator=(HitProbStructure const&) = delete;
+
+  ~HitProbStructure() = default;
+
+  Init const& init() const;
+
+  // Returns ID of the state, where all genes remain in their initial
+  // locations.
+  Index start() const;
+
+  // Returns the number of pairs of genes, which can coalesce in a
+  // specified deme of i-th state.
+  double coal(Index, Index) const;
+
+  // Sets the numerical values of the generator for the parameters.
+  Generator const& fill(Param const&);
+
+  // Sets the numerical values of the generator, and factorizes it.
+  // Symbolic analysis is done only once at the first call.
+  solver_type& factorize(Param const&);
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_HIT_PROB_STRUCTURE_HH
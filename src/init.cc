@@ -25,8 +25,8 @@
 
 
 #include <algorithm>
-#include <functional>
-#include <numeric>
+#include <limits>
+#include <stdexcept>
 #include <vector>
 
 #include "afs.hh"
@@ -73,13 +73,9 @@ Init::Init(AFS const& afs) {
 
   m_data.resize(unsign(deme));
 
-  for (auto allele: afs) {
+  for (decltype(deme) i = 0; i < deme; ++i) {
 
-    for (decltype(deme) i = 0; i < deme; ++i) {
-
-      m_data[unsign(i)] += (allele.first)[i] * allele.second;
-
-    }
+    m_data[unsign(i)] = afs.size(i);
 
   }
 
@@ -111,9 +107,21 @@ Index Init::dim(Index deme) const {
 
 Index Init::dim() const {
 
-  using ::std::accumulate;
+  Index dim = 1;
+
+  for (auto d: m_dim) {
+
+    if (dim > ::std::numeric_limits<Index>::max() / d) {
+
+      throw ::std::overflow_error("number of states does not fit in Index");
+
+    }
+
+    dim *= d;
+
+  }
 
-  return accumulate(m_dim.begin(), m_dim.end(), 1, multiplies<Index>());
+  return dim;
 
 }
 
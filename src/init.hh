@@ -30,6 +30,8 @@
 #include <functional>
 #include <vector>
 
+#include "hash.hh"
+#include "inline_vector.hh"
 #include "typedef.hh"
 #include "util.hh"
 
@@ -48,17 +50,17 @@ class Init {
 
  public:
 
-  typedef typename ::std::vector<Index> value_type;
+  typedef DemeVector value_type;
 
-  typedef typename value_type::iterator iterator;
+  typedef value_type::iterator iterator;
 
-  typedef typename value_type::const_iterator const_iterator;
+  typedef value_type::const_iterator const_iterator;
 
  private:
 
   value_type m_data;
 
-  ::std::vector<Index> m_dim;
+  value_type m_dim;
 
   void set_dim();
 
@@ -92,7 +94,8 @@ class Init {
   Index dim(Index) const;
 
   // Returns the total number dimensions of state space, where all
-  // states are reacheable from this inital condition.
+  // states are reacheable from this inital condition.  Throws
+  // ::std::overflow_error if the number does not fit in Index.
   Index dim() const;
 
   // Returns the number of geens in a specified deme.
@@ -122,21 +125,17 @@ struct hash<::esf::Init> {
 
   ::std::size_t operator()(::esf::Init const& init) const {
 
-    using ::std::size_t;
     using ::esf::unsign;
 
-    size_t mult = 1, value = 0;
+    auto hash = ::esf::hash_mix(unsign(init.deme()));
 
     for (auto i: init) {
 
-      value += unsign(i) * mult;
-      mult <<= 4;
+      hash = ::esf::hash_combine(hash, unsign(i));
 
     }
 
-    ::std::hash<size_t> hasher;
-
-    return hasher(value);
+    return static_cast<::std::size_t>(hash);
 
   }
 
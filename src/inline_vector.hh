@@ -0,0 +1,480 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// inline_vector.hh - Vectors of small fixed capacity
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_INLINE_VECTOR_HH
+#define ESF_MULTI_INLINE_VECTOR_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "typedef.hh"
+
+// Number of demes stored inline.  Numbers of genes per deme are
+// stored inside alleles, states and initial conditions up to this many
+// demes, so that copying them does not allocate memory.  Models with
+// more demes are supported, and their counts are kept on the heap.  It
+// may be changed at configuration time.
+#ifndef ESF_INLINE_DEME
+#define ESF_INLINE_DEME 6
+#endif
+
+namespace esf {
+
+
+// This class is a vector, whose elements are stored inside the object
+// up to a capacity fixed at compile time.  A longer vector keeps its
+// elements in an array allocated on the heap.  Copying a vector, which
+// fits the capacity, copies a block of memory and does not allocate.
+template <typename T, ::std::size_t N>
+class InlineVector {
+
+  static_assert(::std::is_trivially_copyable<T>::value,
+                "elements of InlineVector are copied as raw memory");
+
+ public:
+
+  typedef T value_type;
+
+  typedef T* iterator;
+
+  typedef T const* const_iterator;
+
+  typedef ::std::size_t size_type;
+
+ private:
+
+  T m_data[N];
+
+  // Elements on the heap, or nullptr while they fit in m_data.
+  T* m_heap;
+
+  ::std::uint32_t m_size;
+
+  // The number of elements m_heap can hold.
+  ::std::uint32_t m_capacity;
+
+  // Makes room for the specified number of elements, keeping current
+  // ones.
+  void reserve(size_type);
+
+  // Takes elements of another vector, which is left empty.
+  void take(InlineVector&);
+
+ public:
+
+  InlineVector();
+
+  explicit InlineVector(size_type, T const& = T());
+
+  InlineVector(::std::initializer_list<T>);
+
+  InlineVector(::std::vector<T> const&);
+
+  template <typename Iterator,
+            class = typename ::std::enable_if<
+              !::std::is_integral<Iterator>::value>::type>
+  InlineVector(Iterator, Iterator);
+
+  InlineVector(InlineVector const&);
+
+  InlineVector(InlineVector&&) noexcept;
+
+  InlineVector& operator=(InlineVector const&);
+
+  InlineVector& operator=(InlineVector&&) noexcept;
+
+  ~InlineVector();
+
+  // Returns the number of elements stored inline.
+  static constexpr size_type capacity() { return N; }
+
+  size_type size() const;
+
+  bool empty() const;
+
+  void resize(size_type, T const& = T());
+
+  void push_back(T const&);
+
+  void clear();
+
+  T* data();
+
+  T const* data() const;
+
+  T& operator[](size_type);
+
+  T const& operator[](size_type) const;
+
+  iterator begin();
+
+  const_iterator begin() const;
+
+  iterator end();
+
+  const_iterator end() const;
+
+};
+
+
+template <typename T, ::std::size_t N>
+bool operator==(InlineVector<T, N> const&, InlineVector<T, N> const&);
+
+template <typename T, ::std::size_t N>
+bool operator!=(InlineVector<T, N> const&, InlineVector<T, N> const&);
+
+template <typename T, ::std::size_t N>
+bool operator<(InlineVector<T, N> const&, InlineVector<T, N> const&);
+
+
+// Numbers of genes per deme, as in Allele and Init.
+typedef InlineVector<Index, ESF_INLINE_DEME> DemeVector;
+
+// Numbers of genes per pair of initial and current demes, as in State.
+typedef InlineVector<Index, ESF_INLINE_DEME * ESF_INLINE_DEME> StateVector;
+
+
+// template function definitions
+
+template <typename T, ::std::size_t N>
+void InlineVector<T, N>::reserve(size_type size) {
+
+  if (size <= (m_heap ? m_capacity : N)) {
+
+    return;
+
+  }
+
+  if (size > ::std::numeric_limits<::std::uint32_t>::max()) {
+
+    throw ::std::length_error("InlineVector is too long");
+
+  }
+
+  auto capacity = ::std::max<size_type>(size, 2 * m_capacity);
+
+  capacity = ::std::min<size_type>(capacity,
+                                   ::std::numeric_limits<::std::uint32_t>::max());
+
+  T* heap = new T[capacity];
+
+  ::std::copy(begin(), end(), heap);
+
+  delete[] m_heap;
+
+  m_heap = heap;
+  m_capacity = static_cast<::std::uint32_t>(capacity);
+
+}
+
+
+template <typename T, ::std::size_t N>
+void InlineVector<T, N>::take(InlineVector& other) {
+
+  // A heap array changes hands, and inline elements are copied.
+  if (other.m_heap) {
+
+    m_heap = other.m_heap;
+    m_capacity = other.m_capacity;
+
+    other.m_heap = nullptr;
+    other.m_capacity = 0;
+
+  } else {
+
+    ::std::memcpy(m_data, other.m_data, sizeof(m_data));
+
+  }
+
+  m_size = other.m_size;
+
+  other.m_size = 0;
+
+}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>::InlineVector()
+    : m_data(), m_heap(nullptr), m_size(0), m_capacity(0) {}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>::InlineVector(size_type size, T const& value)
+    : InlineVector() {
+
+  resize(size, value);
+
+}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>::InlineVector(::std::initializer_list<T> values)
+    : InlineVector(values.begin(), values.end()) {}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>::InlineVector(::std::vector<T> const& values)
+    : InlineVector(values.begin(), values.end()) {}
+
+
+template <typename T, ::std::size_t N>
+template <typename Iterator, class>
+InlineVector<T, N>::InlineVector(Iterator first, Iterator last)
+    : InlineVector() {
+
+  for (; first != last; ++first) {
+
+    push_back(*first);
+
+  }
+
+}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>::InlineVector(InlineVector const& other)
+    : m_heap(nullptr), m_size(0), m_capacity(0) {
+
+  *this = other;
+
+}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>::InlineVector(InlineVector&& other) noexcept
+    : m_heap(nullptr), m_size(0), m_capacity(0) {
+
+  take(other);
+
+}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>& InlineVector<T, N>::operator=(InlineVector const& other) {
+
+  if (this == &other) {
+
+    return *this;
+
+  }
+
+  if (!m_heap && !other.m_heap) {
+
+    ::std::memcpy(m_data, other.m_data, sizeof(m_data));
+
+  } else {
+
+    reserve(other.m_size);
+
+    ::std::copy(other.begin(), other.end(), begin());
+
+  }
+
+  m_size = other.m_size;
+
+  return *this;
+
+}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>& InlineVector<T, N>::operator=(InlineVector&& other) noexcept {
+
+  if (this != &other) {
+
+    delete[] m_heap;
+
+    m_heap = nullptr;
+    m_capacity = 0;
+
+    take(other);
+
+  }
+
+  return *this;
+
+}
+
+
+template <typename T, ::std::size_t N>
+InlineVector<T, N>::~InlineVector() {
+
+  delete[] m_heap;
+
+}
+
+
+template <typename T, ::std::size_t N>
+typename InlineVector<T, N>::size_type InlineVector<T, N>::size() const {
+
+  return m_size;
+
+}
+
+
+template <typename T, ::std::size_t N>
+bool InlineVector<T, N>::empty() const {
+
+  return m_size == 0;
+
+}
+
+
+template <typename T, ::std::size_t N>
+void InlineVector<T, N>::resize(size_type size, T const& value) {
+
+  reserve(size);
+
+  if (size > m_size) {
+
+    ::std::fill(begin() + m_size, begin() + size, value);
+
+  }
+
+  m_size = static_cast<::std::uint32_t>(size);
+
+}
+
+
+template <typename T, ::std::size_t N>
+void InlineVector<T, N>::push_back(T const& value) {
+
+  reserve(size() + 1);
+
+  data()[m_size++] = value;
+
+}
+
+
+template <typename T, ::std::size_t N>
+void InlineVector<T, N>::clear() {
+
+  m_size = 0;
+
+}
+
+
+template <typename T, ::std::size_t N>
+T* InlineVector<T, N>::data() {
+
+  return m_heap ? m_heap : m_data;
+
+}
+
+
+template <typename T, ::std::size_t N>
+T const* InlineVector<T, N>::data() const {
+
+  return m_heap ? m_heap : m_data;
+
+}
+
+
+template <typename T, ::std::size_t N>
+T& InlineVector<T, N>::operator[](size_type idx) {
+
+  return data()[idx];
+
+}
+
+
+template <typename T, ::std::size_t N>
+T const& InlineVector<T, N>::operator[](size_type idx) const {
+
+  return data()[idx];
+
+}
+
+
+template <typename T, ::std::size_t N>
+typename InlineVector<T, N>::iterator InlineVector<T, N>::begin() {
+
+  return data();
+
+}
+
+
+template <typename T, ::std::size_t N>
+typename InlineVector<T, N>::const_iterator InlineVector<T, N>::begin() const {
+
+  return data();
+
+}
+
+
+template <typename T, ::std::size_t N>
+typename InlineVector<T, N>::iterator InlineVector<T, N>::end() {
+
+  return data() + m_size;
+
+}
+
+
+template <typename T, ::std::size_t N>
+typename InlineVector<T, N>::const_iterator InlineVector<T, N>::end() const {
+
+  return data() + m_size;
+
+}
+
+
+template <typename T, ::std::size_t N>
+bool operator==(InlineVector<T, N> const& lhs, InlineVector<T, N> const& rhs) {
+
+  return lhs.size() == rhs.size() &&
+    ::std::equal(lhs.begin(), lhs.end(), rhs.begin());
+
+}
+
+
+template <typename T, ::std::size_t N>
+bool operator!=(InlineVector<T, N> const& lhs, InlineVector<T, N> const& rhs) {
+
+  return !(lhs == rhs);
+
+}
+
+
+template <typename T, ::std::size_t N>
+bool operator<(InlineVector<T, N> const& lhs, InlineVector<T, N> const& rhs) {
+
+  return ::std::lexicographical_compare(lhs.begin(), lhs.end(),
+                                        rhs.begin(), rhs.end());
+
+}
+
+
+}
+
+
+#endif // ESF_MULTI_INLINE_VECTOR_HH
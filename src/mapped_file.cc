@@ -0,0 +1,91 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// mapped_file.cc - Read-only memory mapping of a file
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.hh"
+
+namespace esf {
+
+
+MappedFile::MappedFile(::std::string const& path)
+    : m_data(nullptr), m_size(0) {
+
+  auto fd = ::open(path.c_str(), O_RDONLY);
+
+  if (fd < 0) {
+
+    throw ::std::runtime_error("cannot open " + path);
+
+  }
+
+  struct stat st;
+
+  if (::fstat(fd, &st) != 0) {
+
+    ::close(fd);
+
+    throw ::std::runtime_error("cannot stat " + path);
+
+  }
+
+  m_size = static_cast<::std::size_t>(st.st_size);
+
+  if (m_size > 0) {
+
+    m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+
+  }
+
+  // The mapping stays valid after the descriptor is closed.
+  ::close(fd);
+
+  if (m_data == MAP_FAILED) {
+
+    throw ::std::runtime_error("cannot map " + path);
+
+  }
+
+}
+
+
+MappedFile::~MappedFile() {
+
+  if (m_data) {
+
+    ::munmap(m_data, m_size);
+
+  }
+
+}
+
+
+}
@@ -0,0 +1,67 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// mapped_file.hh - Read-only memory mapping of a file
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_MAPPED_FILE_HH
+#define ESF_MULTI_MAPPED_FILE_HH
+
+#include <cstddef>
+#include <string>
+
+namespace esf {
+
+
+// This class maps a whole file into memory read-only.  Pages are
+// shared with other processes mapping the same file, and the mapping
+// is released on destruction.  An empty file is mapped to no memory.
+class MappedFile {
+
+ private:
+
+  void* m_data;
+
+  ::std::size_t m_size;
+
+ public:
+
+  // Throws std::runtime_error if the file cannot be opened or mapped.
+  explicit MappedFile(::std::string const&);
+
+  MappedFile(MappedFile const&) = delete;
+
+  MappedFile& operator=(MappedFile const&) = delete;
+
+  ~MappedFile();
+
+  char const* data() const { return static_cast<char const*>(m_data); }
+
+  ::std::size_t size() const { return m_size; }
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_MAPPED_FILE_HH
@@ -0,0 +1,188 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// neighbor_table.cc - States reacheable by single migration
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "neighbor_table.hh"
+#include "param.hh"
+#include "state_space.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+NeighborTable::NeighborTable(StateSpace const& space)
+    : m_space(space), m_deme(space.deme()) {
+
+  using ::std::vector;
+
+  auto const& init = m_space.init();
+
+  auto d = unsign(m_deme);
+
+  m_first.resize(d + 1);
+
+  m_first[0] = 0;
+
+  for (decltype(d) b = 0; b < d; ++b) {
+
+    m_first[b + 1] = m_first[b] + init.dim(sign(b));
+
+  }
+
+  m_comp.reserve(unsign(m_first[d]) * d);
+
+  m_ptr.reserve(unsign(m_first[d]) + 1);
+  m_ptr.push_back(0);
+
+  vector<Index> comp(d);
+
+  for (decltype(d) b = 0; b < d; ++b) {
+
+    auto genes = init[sign(b)];
+
+    auto stride = m_space.stride(sign(b));
+
+    for (Index r = 0; r < init.dim(sign(b)); ++r) {
+
+      m_space.unrank(r, genes, comp.data());
+
+      m_comp.insert(m_comp.end(), comp.begin(), comp.end());
+
+      for (decltype(d) p = 0; p < d; ++p) {
+
+        if (comp[p] == 0) {
+
+          continue;
+
+        }
+
+        for (decltype(d) q = 0; q < d; ++q) {
+
+          if (p == q) {
+
+            continue;
+
+          }
+
+          --comp[p];
+          ++comp[q];
+
+          m_delta.push_back((m_space.rank(comp.data()) - r) * stride);
+          m_src.push_back(sign(b * d + p));
+          m_tar.push_back(sign(b * d + q));
+          m_back.push_back(comp[q]);
+
+          ++comp[p];
+          --comp[q];
+
+          m_genes.push_back(comp[p]);
+
+        }
+
+      }
+
+      m_ptr.push_back(sign(m_delta.size()));
+
+    }
+
+  }
+
+}
+
+
+StateSpace const& NeighborTable::space() const {
+
+  return m_space;
+
+}
+
+
+Index NeighborTable::size(Index b) const {
+
+  return m_first[unsign(b + 1)] - m_first[unsign(b)];
+
+}
+
+
+Index const* NeighborTable::composition(Index b, Index rank) const {
+
+  return m_comp.data() + (m_first[unsign(b)] + rank) * m_deme;
+
+}
+
+
+void NeighborTable::ranks(Index id, Index* r) const {
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    r[b] = id / m_space.stride(b) % size(b);
+
+  }
+
+}
+
+
+Index NeighborTable::degree(Index const* ranks) const {
+
+  Index count = 0;
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    auto c = unsign(m_first[unsign(b)] + ranks[b]);
+
+    count += m_ptr[c + 1] - m_ptr[c];
+
+  }
+
+  return count;
+
+}
+
+
+Index NeighborTable::moves() const {
+
+  return sign(m_delta.size());
+
+}
+
+
+double NeighborTable::rate(Move const& move, Param const& param) const {
+
+  return move.genes * param.mig_rate(move.src % m_deme, move.tar % m_deme);
+
+}
+
+
+double NeighborTable::back_rate(Index k, Param const& param) const {
+
+  auto uk = unsign(k);
+
+  return m_back[uk] * param.mig_rate(m_tar[uk] % m_deme, m_src[uk] % m_deme);
+
+}
+
+
+}
@@ -0,0 +1,154 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// neighbor_table.hh - States reacheable by single migration
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef ESF_MULTI_NEIGHBOR_TABLE_HH
+#define ESF_MULTI_NEIGHBOR_TABLE_HH
+
+#include <vector>
+
+#include "param.hh"
+#include "state_space.hh"
+#include "typedef.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+// A migration from a state to its neighbor.  Slots are positions in
+// the layout of State, and the number of genes is that of the source
+// slot.
+struct Move {
+
+  Index id;
+
+  Index src;
+
+  Index tar;
+
+  Index genes;
+
+  // Position of the migration in the table, by which a value can be
+  // tabulated for every migration.
+  Index index;
+
+};
+
+
+// This class enumerates neighbors of states without building them.
+//
+// A migration changes the composition of a single deme of origin, so
+// IDs of a state and its neighbor differ by the change of the rank of
+// that composition times the stride of the origin.  All such changes
+// are tabulated for every composition of every origin.  Enumerating a
+// neighbor is then a lookup and an addition, and it does not allocate
+// memory.
+class NeighborTable {
+
+ private:
+
+  StateSpace m_space;
+
+  Index m_deme;
+
+  // Compositions of all origins are numbered consecutively, and those
+  // of the b-th origin start from m_first[b].
+  ::std::vector<Index> m_first;
+
+  // Number of genes in each current deme for every composition.
+  ::std::vector<Index> m_comp;
+
+  // Migrations from each composition as compressed rows.
+  ::std::vector<Index> m_ptr;
+
+  ::std::vector<Index> m_delta;
+
+  ::std::vector<Index> m_src;
+
+  ::std::vector<Index> m_tar;
+
+  ::std::vector<Index> m_genes;
+
+  // Number of genes in the target slot after each migration, which can
+  // migrate back.
+  ::std::vector<Index> m_back;
+
+ public:
+
+  NeighborTable(StateSpace const&);
+
+  StateSpace const& space() const;
+
+  // Returns the number of compositions of a deme of origin.
+  Index size(Index) const;
+
+  // Returns a composition of a deme of origin given its rank.
+  Index const* composition(Index, Index) const;
+
+  // Sets ranks of compositions of a state.
+  void ranks(Index, Index*) const;
+
+  // Calls a function with Move of every neighbor of a state.  The state
+  // is given as its ID and ranks of its compositions.
+  template <typename F>
+  void for_each(Index, Index const*, F) const;
+
+  // Returns the number of neighbors of a state given ranks of its
+  // compositions.
+  Index degree(Index const*) const;
+
+  // Returns the number of migrations in the table.
+  Index moves() const;
+
+  // Returns the rate of a migration.
+  double rate(Move const&, Param const&) const;
+
+  // Returns the rate of the migration from a neighbor back to the
+  // state, given the position of the forward migration.
+  double back_rate(Index, Param const&) const;
+
+};
+
+
+template <typename F>
+void NeighborTable::for_each(Index id, Index const* ranks, F f) const {
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    auto c = unsign(m_first[unsign(b)] + ranks[b]);
+
+    for (auto k = unsign(m_ptr[c]); k < unsign(m_ptr[c + 1]); ++k) {
+
+      f(Move({id + m_delta[k], m_src[k], m_tar[k], m_genes[k], sign(k)}));
+
+    }
+
+  }
+
+}
+
+
+}
+
+
+#endif // ESF_MULTI_NEIGHBOR_TABLE_HH
@@ -23,6 +23,10 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 // DEALINGS IN THE SOFTWARE.
 
+#include <cstdint>
+#include <cstring>
+
+#include "hash.hh"
 #include "param.hh"
 #include "util.hh"
 
@@ -71,4 +75,30 @@ double& Param::pop_size(Index i) {
 }
 
 
+::std::uint64_t Param::fingerprint() const {
+
+  auto hash = hash_mix(m_pop.size());
+
+  for (auto const* values: {&m_mig, &m_pop, &m_mut}) {
+
+    for (auto v: *values) {
+
+      // Both zeros are the same parameter.
+      v = v == 0.0 ? 0.0 : v;
+
+      ::std::uint64_t bits;
+
+      ::std::memcpy(&bits, &v, sizeof(bits));
+
+      hash = hash_combine(hash, bits);
+
+    }
+
+  }
+
+  return hash;
+
+}
+
+
 }
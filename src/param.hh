@@ -27,6 +27,7 @@
 #define ESF_MULTI_PARAM_HH
 
 
+#include <cstdint>
 #include <vector>
 
 
@@ -93,6 +94,11 @@ class Param {
 
   double& pop_size(Index);
 
+  // Returns a 64 bit hash of the number of demes and all parameters.
+  // Equal parameters have the same fingerprint in any process, so
+  // that results can be stored and looked up by it.
+  ::std::uint64_t fingerprint() const;
+
 };
 
 
@@ -0,0 +1,115 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// reach_cache.cc - Cache of AFS reacheable by migrations
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "hash.hh"
+#include "reach_cache.hh"
+#include "state.hh"
+
+namespace esf {
+
+
+ReachCache::ReachCache(::std::size_t shards)
+    : m_size(shards > 0 ? shards : 1),
+      m_shards(new Shard[m_size]),
+      m_alleles(), m_exits() {}
+
+
+ReachCache::Shard& ReachCache::shard(AFS const& afs) {
+
+  // Mixed, so that shards are not correlated with slots of the table.
+  return m_shards[hash_mix(afs.hash()) % m_size];
+
+}
+
+
+::std::vector<ReachCache::Exit> const& ReachCache::exits(AFS const& afs) {
+
+  return m_exits.get_or_compute(afs, [this, &afs]() { return expand(afs); });
+
+}
+
+
+::std::vector<ReachCache::Exit> ReachCache::expand(AFS const& afs) {
+
+  ::std::vector<Exit> retval;
+
+  // States are enumerated outside of the lock.
+  afs.reacheable([this, &retval](AFS const& exit, State const& state)
+                 {
+                   auto& s = shard(exit);
+
+                   ::std::lock_guard<::std::mutex> lock(s.mutex);
+
+                   // Interned AFS do not move as the table grows.
+                   auto const& interned = s.table[s.table.intern(exit)];
+
+                   retval.push_back({&interned, state.id()});
+                 },
+                 m_alleles);
+
+  return retval;
+
+}
+
+
+::std::size_t ReachCache::size() {
+
+  ::std::size_t total = 0;
+
+  for (::std::size_t i = 0; i < m_size; ++i) {
+
+    ::std::lock_guard<::std::mutex> lock(m_shards[i].mutex);
+
+    total += m_shards[i].table.size();
+
+  }
+
+  return total;
+
+}
+
+
+void ReachCache::clear() {
+
+  m_exits.clear();
+
+  m_alleles.clear();
+
+  for (::std::size_t i = 0; i < m_size; ++i) {
+
+    m_shards[i].table = AFSTable();
+
+  }
+
+}
+
+
+}
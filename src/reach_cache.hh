@@ -0,0 +1,116 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// reach_cache.hh - Cache of AFS reacheable by migrations
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_REACH_CACHE_HH
+#define ESF_MULTI_REACH_CACHE_HH
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "allele.hh"
+#include "concurrent_cache.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class keeps AFS::reacheable() of each AFS, so that a sample
+// shared by many parents is expanded only once.  An exit is kept as a
+// pointer to the reached AFS, which is interned once in tables shared
+// by all expansions, and the ID of its state.  Neither the state space
+// nor the state vector is kept.  Reached AFS are distributed over
+// shards by their hash, each guarded by its own mutex, and exits of
+// alleles are kept as well, since alleles recur across samples.
+//
+// Exits are listed in the order of AFS::reacheable().  The cache may
+// be used by several threads at once.
+class ReachCache {
+
+ public:
+
+  struct Exit {
+
+    AFS const* afs;
+
+    Index state;
+
+  };
+
+ private:
+
+  struct Shard {
+
+    ::std::mutex mutex;
+
+    AFSTable table;
+
+  };
+
+  ::std::size_t m_size;
+
+  ::std::unique_ptr<Shard[]> m_shards;
+
+  AlleleExitCache m_alleles;
+
+  ConcurrentCache<AFS, ::std::vector<Exit>> m_exits;
+
+  Shard& shard(AFS const&);
+
+  ::std::vector<Exit> expand(AFS const&);
+
+ public:
+
+  // Creates a cache with the specified number of shards of reached
+  // AFS.
+  explicit ReachCache(::std::size_t = 64);
+
+  ReachCache(ReachCache const&) = delete;
+
+  ReachCache& operator=(ReachCache const&) = delete;
+
+  ~ReachCache() = default;
+
+  // Returns the exits of the AFS.  The reference stays valid until
+  // the cache is cleared.
+  ::std::vector<Exit> const& exits(AFS const&);
+
+  // Returns the number of distinct AFS reached so far.
+  ::std::size_t size();
+
+  // Removes all expansions.  No other thread may use the cache
+  // meanwhile.
+  void clear();
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_REACH_CACHE_HH
@@ -0,0 +1,559 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// record_store.cc - Append-only store of records on disk
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "array_view.hh"
+#include "hash.hh"
+#include "mapped_file.hh"
+#include "record_store.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+namespace {
+
+
+struct StoreHeader {
+
+  char magic[8];
+
+  ::std::uint32_t version;
+
+  ::std::uint32_t byte_order;
+
+};
+
+
+struct IndexHeader {
+
+  char magic[8];
+
+  ::std::uint32_t version;
+
+  ::std::uint32_t byte_order;
+
+  // Length of the data file covered by the index.
+  ::std::uint64_t data_length;
+
+  ::std::uint64_t count;
+
+};
+
+
+char const index_magic[8] = {'E', 'S', 'F', 'I', 'N', 'D', 'E', 'X'};
+
+// Version 2 added the number of values to records, and version 3 the
+// solver options to keys of hitting probabilities.  Data files of
+// other versions are rejected, and index files of other versions are
+// ignored.
+::std::uint32_t const store_version = 3;
+
+::std::uint32_t const store_byte_order = 0x01020304;
+
+
+static_assert(sizeof(IndexHeader) % 8 == 0, "header breaks alignment");
+static_assert(sizeof(RecordStore::Entry) == 16, "entries must not be padded");
+
+
+// A record is the fingerprint, the number of values, the length of
+// the encoding, the encoding and the values.  Records are not
+// aligned, and they are read by copying bytes.
+::std::size_t const record_head = 2 * sizeof(::std::uint64_t) + sizeof(::std::uint32_t);
+
+
+::std::size_t record_size(::std::uint32_t length, ::std::uint64_t count) {
+
+  return record_head + length * sizeof(::std::uint32_t) + count * sizeof(double);
+
+}
+
+
+::std::uint64_t key_of(::std::uint64_t fingerprint,
+                       ::std::uint32_t const* codes, ::std::size_t length) {
+
+  auto key = hash_mix(fingerprint);
+
+  for (::std::size_t i = 0; i < length; ++i) {
+
+    key = hash_combine(key, codes[i]);
+
+  }
+
+  return key;
+
+}
+
+
+template <typename T>
+T load(char const* pos) {
+
+  T value;
+
+  ::std::memcpy(&value, pos, sizeof(T));
+
+  return value;
+
+}
+
+
+// Tests if a complete record starts at the position of a data file of
+// the size.
+bool record_fits(char const* data, ::std::uint64_t size, ::std::uint64_t pos) {
+
+  if (pos < sizeof(StoreHeader) || pos > size || size - pos < record_head) {
+
+    return false;
+
+  }
+
+  auto record = data + pos;
+
+  auto length = load<::std::uint32_t>(record + 16);
+
+  auto count = load<::std::uint64_t>(record + 8);
+
+  return count <= size / sizeof(double) && record_size(length, count) <= size - pos;
+
+}
+
+
+bool matches(char const* record, ::std::uint64_t fingerprint,
+             ::std::vector<::std::uint32_t> const& codes) {
+
+  return load<::std::uint64_t>(record) == fingerprint
+      && load<::std::uint32_t>(record + 16) == codes.size()
+      && ::std::memcmp(record + record_head, codes.data(),
+                       codes.size() * sizeof(::std::uint32_t)) == 0;
+
+}
+
+
+// Returns the values of a matching record, and sets their number.
+char const* values(char const* record, ::std::size_t& count) {
+
+  count = load<::std::uint64_t>(record + 8);
+
+  return record + record_size(load<::std::uint32_t>(record + 16), 0);
+
+}
+
+
+// Looks up the record of a key among sorted entries.
+char const* search(ArrayView<RecordStore::Entry> entries, char const* base,
+                   ::std::uint64_t key, ::std::uint64_t fingerprint,
+                   ::std::vector<::std::uint32_t> const& codes,
+                   ::std::size_t& count) {
+
+  auto itr = ::std::lower_bound(entries.begin(), entries.end(), key,
+                                [](RecordStore::Entry const& e, ::std::uint64_t k)
+                                {
+                                  return e.key < k;
+                                });
+
+  for (; itr != entries.end() && itr->key == key; ++itr) {
+
+    auto record = base + itr->offset;
+
+    if (matches(record, fingerprint, codes)) {
+
+      return values(record, count);
+
+    }
+
+  }
+
+  return nullptr;
+
+}
+
+
+bool entry_less(RecordStore::Entry const& a, RecordStore::Entry const& b) {
+
+  return a.key < b.key || (a.key == b.key && a.offset < b.offset);
+
+}
+
+
+}
+
+
+RecordStore::RecordStore(::std::string const& path, char const (&magic)[8],
+                         ::std::size_t batch)
+    : m_path(path), m_batch(::std::max<::std::size_t>(1, batch)),
+      m_pending_count(0) {
+
+  ::std::memcpy(m_magic, magic, sizeof(m_magic));
+
+  if (!::std::ifstream(m_path)) {
+
+    StoreHeader header;
+
+    ::std::memcpy(header.magic, m_magic, sizeof(m_magic));
+
+    header.version = store_version;
+    header.byte_order = store_byte_order;
+
+    ::std::ofstream out(m_path, ::std::ios::binary);
+
+    out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    out.close();
+
+    if (!out) {
+
+      throw ::std::runtime_error("cannot create store: " + m_path);
+
+    }
+
+  }
+
+  open();
+
+}
+
+
+RecordStore::~RecordStore() {
+
+  try {
+
+    flush();
+
+  } catch (...) {}
+
+}
+
+
+void RecordStore::open() {
+
+  m_data = ::std::make_shared<MappedFile>(m_path);
+
+  if (m_data->size() < sizeof(StoreHeader)) {
+
+    throw ::std::runtime_error("not a store: " + m_path);
+
+  }
+
+  auto const& header = *reinterpret_cast<StoreHeader const*>(m_data->data());
+
+  if (::std::memcmp(header.magic, m_magic, sizeof(m_magic)) != 0
+      || header.byte_order != store_byte_order
+      || header.version != store_version) {
+
+    throw ::std::runtime_error("not a store of this kind and version: " + m_path);
+
+  }
+
+  m_index.reset();
+  m_entries = ArrayView<Entry>();
+  m_recent.clear();
+
+  auto indexed = sizeof(StoreHeader);
+
+  // An index which does not fit the data, or whose entries do not
+  // point at complete records of the data it covers, is ignored, and
+  // records are indexed again.
+  if (::std::ifstream(m_path + ".idx")) {
+
+    auto index = ::std::make_shared<MappedFile>(m_path + ".idx");
+
+    auto const* ih = reinterpret_cast<IndexHeader const*>(index->data());
+
+    if (index->size() >= sizeof(IndexHeader)
+        && ::std::memcmp(ih->magic, index_magic, sizeof(index_magic)) == 0
+        && ih->byte_order == store_byte_order
+        && ih->version == store_version
+        && ih->count == (index->size() - sizeof(IndexHeader)) / sizeof(Entry)
+        && index->size() == sizeof(IndexHeader) + ih->count * sizeof(Entry)
+        && ih->data_length >= sizeof(StoreHeader)
+        && ih->data_length <= m_data->size()) {
+
+      ArrayView<Entry> entries(
+          reinterpret_cast<Entry const*>(index->data() + sizeof(IndexHeader)),
+          ih->count);
+
+      auto data = m_data->data();
+
+      auto length = ih->data_length;
+
+      if (::std::all_of(entries.begin(), entries.end(),
+                        [data, length](Entry const& e)
+                        {
+                          return record_fits(data, length, e.offset);
+                        })) {
+
+        m_index = index;
+        m_entries = entries;
+
+        indexed = ih->data_length;
+
+      }
+
+    }
+
+  }
+
+  scan(indexed);
+
+}
+
+
+void RecordStore::scan(::std::size_t pos) {
+
+  auto size = m_data->size();
+
+  while (record_fits(m_data->data(), size, pos)) {
+
+    auto record = m_data->data() + pos;
+
+    auto length = load<::std::uint32_t>(record + 16);
+
+    auto rsize = record_size(length, load<::std::uint64_t>(record + 8));
+
+    ::std::vector<::std::uint32_t> codes(length);
+
+    ::std::memcpy(codes.data(), record + record_head, length * sizeof(::std::uint32_t));
+
+    m_recent.push_back({key_of(load<::std::uint64_t>(record), codes.data(), length), pos});
+
+    pos += rsize;
+
+  }
+
+  ::std::sort(m_recent.begin(), m_recent.end(), entry_less);
+
+  // A record partially written by an interrupted run is dropped, so
+  // that new records are appended after complete ones.
+  if (pos != size) {
+
+    m_data.reset();
+
+    if (::truncate(m_path.c_str(), static_cast<off_t>(pos)) != 0) {
+
+      throw ::std::runtime_error("cannot truncate store: " + m_path);
+
+    }
+
+    m_data = ::std::make_shared<MappedFile>(m_path);
+
+  }
+
+}
+
+
+char const* RecordStore::find(::std::uint64_t fingerprint,
+                              ::std::vector<::std::uint32_t> const& codes,
+                              ::std::size_t& count) const {
+
+  auto key = key_of(fingerprint, codes.data(), codes.size());
+
+  if (auto found = search(m_entries, m_data->data(), key, fingerprint, codes, count)) {
+
+    return found;
+
+  }
+
+  if (auto found = search(m_recent, m_data->data(), key, fingerprint, codes, count)) {
+
+    return found;
+
+  }
+
+  auto range = m_pending_offsets.equal_range(key);
+
+  for (auto itr = range.first; itr != range.second; ++itr) {
+
+    auto record = m_pending.data() + itr->second;
+
+    if (matches(record, fingerprint, codes)) {
+
+      return values(record, count);
+
+    }
+
+  }
+
+  return nullptr;
+
+}
+
+
+void RecordStore::insert(::std::uint64_t fingerprint,
+                         ::std::vector<::std::uint32_t> const& codes,
+                         double const* data, ::std::size_t count) {
+
+  ::std::size_t found;
+
+  if (find(fingerprint, codes, found)) {
+
+    return;
+
+  }
+
+  auto length = static_cast<::std::uint32_t>(codes.size());
+
+  ::std::uint64_t n = count;
+
+  auto offset = m_pending.size();
+
+  m_pending.resize(offset + record_size(length, n));
+
+  auto record = m_pending.data() + offset;
+
+  ::std::memcpy(record, &fingerprint, sizeof(fingerprint));
+  ::std::memcpy(record + 8, &n, sizeof(n));
+  ::std::memcpy(record + 16, &length, sizeof(length));
+  ::std::memcpy(record + record_head, codes.data(), length * sizeof(::std::uint32_t));
+  if (count > 0) {
+
+    ::std::memcpy(record + record_size(length, 0), data, count * sizeof(double));
+
+  }
+
+  m_pending_offsets.emplace(key_of(fingerprint, codes.data(), codes.size()), offset);
+
+  if (++m_pending_count >= m_batch) {
+
+    write_pending();
+
+  }
+
+}
+
+
+void RecordStore::write_pending() {
+
+  if (m_pending_count == 0) {
+
+    return;
+
+  }
+
+  auto base = m_data->size();
+
+  {
+    ::std::ofstream out(m_path, ::std::ios::binary | ::std::ios::app);
+
+    out.write(m_pending.data(), static_cast<::std::streamsize>(m_pending.size()));
+
+    out.close();
+
+    if (!out) {
+
+      throw ::std::runtime_error("cannot write store: " + m_path);
+
+    }
+  }
+
+  // Only entries of the batch are sorted, and they are merged into
+  // those already sorted.
+  auto middle = m_recent.size();
+
+  for (auto const& p: m_pending_offsets) {
+
+    m_recent.push_back({p.first, base + p.second});
+
+  }
+
+  ::std::sort(m_recent.begin() + sign(middle), m_recent.end(), entry_less);
+  ::std::inplace_merge(m_recent.begin(), m_recent.begin() + sign(middle),
+                       m_recent.end(), entry_less);
+
+  m_pending.clear();
+  m_pending_offsets.clear();
+  m_pending_count = 0;
+
+  m_data = ::std::make_shared<MappedFile>(m_path);
+
+}
+
+
+void RecordStore::flush() {
+
+  write_pending();
+
+  if (m_recent.empty()) {
+
+    return;
+
+  }
+
+  IndexHeader header;
+
+  ::std::memcpy(header.magic, index_magic, sizeof(index_magic));
+
+  header.version = store_version;
+  header.byte_order = store_byte_order;
+  header.data_length = m_data->size();
+  header.count = m_entries.size() + m_recent.size();
+
+  ::std::vector<Entry> entries(header.count);
+
+  ::std::merge(m_entries.begin(), m_entries.end(), m_recent.begin(), m_recent.end(),
+               entries.begin(), entry_less);
+
+  // The index is replaced at once, so that readers see either the old
+  // or the new one.  If it is not written, records are indexed again
+  // on opening.
+  auto tmp = m_path + ".idx.tmp";
+
+  ::std::ofstream out(tmp, ::std::ios::binary | ::std::ios::trunc);
+
+  out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+  out.write(reinterpret_cast<char const*>(entries.data()),
+            static_cast<::std::streamsize>(entries.size() * sizeof(Entry)));
+
+  out.close();
+
+  if (!out || ::std::rename(tmp.c_str(), (m_path + ".idx").c_str()) != 0) {
+
+    throw ::std::runtime_error("cannot write store index: " + m_path);
+
+  }
+
+  open();
+
+}
+
+
+::std::size_t RecordStore::size() const {
+
+  return m_entries.size() + m_recent.size() + m_pending_count;
+
+}
+
+
+}
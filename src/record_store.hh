@@ -0,0 +1,146 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// record_store.hh - Append-only store of records on disk
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_RECORD_STORE_HH
+#define ESF_MULTI_RECORD_STORE_HH
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "array_view.hh"
+#include "mapped_file.hh"
+
+namespace esf {
+
+
+// This class keeps arrays of doubles on disk across runs.  An array
+// is keyed by a fingerprint of parameters (see Param::fingerprint())
+// and a canonical encoding of what the values are about, as an array
+// of 32 bit integers.
+//
+// Records are appended to a data file and never rewritten.  A sorted
+// array of (hash of key, offset of record) pairs is kept in an index
+// file next to it, and both files are mapped read-only, so that
+// opening a store does not read it.  Lookups compare full keys, so
+// that colliding hashes do not mix up records.  New records are held
+// in memory and appended in batches, and their entries are merged into
+// a sorted array in memory.  The index file is rewritten only by
+// flush() and on destruction.  Records appended after the index was
+// last written, for example by a run that did not finish, are indexed
+// on opening, and a record partially written is dropped.  Entries of
+// the index file are checked to point at complete records on opening,
+// and all records are indexed again if any of them does not.
+//
+// A store is used by one thread and written by one process at a time.
+class RecordStore {
+
+ public:
+
+  struct Entry {
+
+    ::std::uint64_t key;
+
+    ::std::uint64_t offset;
+
+  };
+
+ private:
+
+  ::std::string m_path;
+
+  char m_magic[8];
+
+  ::std::size_t m_batch;
+
+  ::std::shared_ptr<MappedFile> m_data;
+
+  ::std::shared_ptr<MappedFile> m_index;
+
+  // Sorted entries in the index file.
+  ArrayView<Entry> m_entries;
+
+  // Sorted entries of records in the data file, which are missing in
+  // the index file.
+  ::std::vector<Entry> m_recent;
+
+  // Records not yet written, and their offsets in the buffer.
+  ::std::vector<char> m_pending;
+
+  ::std::unordered_multimap<::std::uint64_t, ::std::uint64_t> m_pending_offsets;
+
+  ::std::size_t m_pending_count;
+
+  void open();
+
+  void scan(::std::size_t);
+
+  // Appends records held in memory to the data file.
+  void write_pending();
+
+ public:
+
+  // Opens the store at the path, creating it if it does not exist.
+  // The magic tells kinds of stores apart.  The index is written to
+  // the path followed by ".idx".  Records are written every specified
+  // number of insertions.  Throws std::runtime_error if files cannot
+  // be read or written, or if they are not a store of the kind.
+  RecordStore(::std::string const&, char const (&)[8], ::std::size_t);
+
+  RecordStore(RecordStore const&) = delete;
+
+  RecordStore& operator=(RecordStore const&) = delete;
+
+  // Writes records not yet written.  Errors are ignored.
+  ~RecordStore();
+
+  // Looks up the values of a key.  Returns a pointer to the bytes of
+  // the values and sets their number, or returns nullptr if the key is
+  // not found.  The bytes are not aligned, and they stay valid until
+  // the next insertion.
+  char const* find(::std::uint64_t, ::std::vector<::std::uint32_t> const&,
+                   ::std::size_t&) const;
+
+  // Stores values of a key, unless the key is already stored.
+  void insert(::std::uint64_t, ::std::vector<::std::uint32_t> const&,
+              double const*, ::std::size_t);
+
+  // Writes records held in memory, and rewrites the index with all
+  // records.
+  void flush();
+
+  // Returns the number of records.
+  ::std::size_t size() const;
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_RECORD_STORE_HH
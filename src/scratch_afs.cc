@@ -0,0 +1,267 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// scratch_afs.cc - Allele frequency spectrum modified in place
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "scratch_afs.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+namespace {
+
+
+::std::vector<AFS::value_type>::iterator
+lower_bound(::std::vector<AFS::value_type>& data, Allele const& allele) {
+
+  return ::std::lower_bound(data.begin(), data.end(), allele,
+                            [](AFS::value_type const& p, Allele const& a)
+                            {
+                              return p.first < a;
+                            });
+
+}
+
+
+}
+
+
+ScratchAFS::ScratchAFS(AFS const& afs)
+    : m_data(afs.m_data), m_size(afs.m_size), m_sizes(afs.m_sizes),
+      m_hash(afs.m_hash), m_log() {}
+
+
+void ScratchAFS::insert(Allele const& allele) {
+
+  auto itr = lower_bound(m_data, allele);
+
+  if (itr != m_data.end() && itr->first == allele) {
+
+    m_hash -= AFS::entry_hash(*itr);
+
+    ++itr->second;
+
+  } else {
+
+    itr = m_data.emplace(itr, allele, 1);
+
+  }
+
+  m_hash += AFS::entry_hash(*itr);
+
+  for (decltype(m_sizes.size()) d = 0; d < m_sizes.size(); ++d) {
+
+    m_sizes[d] += allele[sign(d)];
+
+  }
+
+  m_size += allele.size();
+
+}
+
+
+void ScratchAFS::erase(Allele const& allele) {
+
+  auto itr = lower_bound(m_data, allele);
+
+  m_hash -= AFS::entry_hash(*itr);
+
+  if (itr->second > 1) {
+
+    --itr->second;
+
+    m_hash += AFS::entry_hash(*itr);
+
+  } else {
+
+    m_data.erase(itr);
+
+  }
+
+  for (decltype(m_sizes.size()) d = 0; d < m_sizes.size(); ++d) {
+
+    m_sizes[d] -= allele[sign(d)];
+
+  }
+
+  m_size -= allele.size();
+
+}
+
+
+void ScratchAFS::apply(Allele const& removed, Allele const& added) {
+
+  Change change{removed, added, false, false};
+
+  if (removed.size() != 0 && (*this)[removed] > 0) {
+
+    erase(removed);
+
+    change.erased = true;
+
+  }
+
+  if (added.size() != 0) {
+
+    insert(added);
+
+    change.inserted = true;
+
+  }
+
+  m_log.push_back(change);
+
+}
+
+
+void ScratchAFS::undo() {
+
+  if (m_log.empty()) {
+
+    return;
+
+  }
+
+  auto const& change = m_log.back();
+
+  if (change.inserted) {
+
+    erase(change.added);
+
+  }
+
+  if (change.erased) {
+
+    insert(change.removed);
+
+  }
+
+  m_log.pop_back();
+
+}
+
+
+::std::size_t ScratchAFS::depth() const {
+
+  return m_log.size();
+
+}
+
+
+AFS ScratchAFS::afs() const {
+
+  AFS retval;
+
+  retval.m_data.assign(m_data.begin(), m_data.end());
+  retval.m_size = m_size;
+  retval.m_sizes = m_sizes;
+  retval.m_hash = m_hash;
+
+  return retval;
+
+}
+
+
+Index ScratchAFS::operator[](Allele const& allele) const {
+
+  auto itr = ::std::lower_bound(m_data.begin(), m_data.end(), allele,
+                                [](value_type const& p, Allele const& a)
+                                {
+                                  return p.first < a;
+                                });
+
+  return itr != m_data.end() && itr->first == allele ? itr->second : 0;
+
+}
+
+
+Index ScratchAFS::size(Index deme) const {
+
+  return m_sizes[unsign(deme)];
+
+}
+
+
+Index ScratchAFS::size() const {
+
+  return m_size;
+
+}
+
+
+Index ScratchAFS::deme() const {
+
+  return sign(m_sizes.size());
+
+}
+
+
+::std::size_t ScratchAFS::hash() const {
+
+  return m_hash;
+
+}
+
+
+ScratchAFS::const_iterator ScratchAFS::begin() const {
+
+  return m_data.begin();
+
+}
+
+
+ScratchAFS::const_iterator ScratchAFS::end() const {
+
+  return m_data.end();
+
+}
+
+
+bool ScratchAFS::equals(AFS const& afs) const {
+
+  return m_hash == afs.m_hash && m_data == afs.m_data;
+
+}
+
+
+bool operator==(AFS const& a, ScratchAFS const& b) {
+
+  return b.equals(a);
+
+}
+
+
+bool operator==(ScratchAFS const& a, AFS const& b) {
+
+  return a.equals(b);
+
+}
+
+
+}
@@ -0,0 +1,130 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// scratch_afs.hh - Allele frequency spectrum modified in place
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_SCRATCH_AFS_HH
+#define ESF_MULTI_SCRATCH_AFS_HH
+
+#include <cstddef>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "inline_vector.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class is a mutable copy of AFS for walking over samples which
+// differ from a base sample by a few alleles.  apply() removes an
+// allele and adds another in place, and undo() reverts the last
+// apply().  Sizes and the hash are updated one allele at a time, and
+// the hash equals that of the AFS with the same alleles, so that a
+// table of AFS can be probed without building one.  afs() makes a
+// persistent copy.
+class ScratchAFS {
+
+ public:
+
+  typedef AFS::value_type value_type;
+
+  typedef ::std::vector<value_type>::const_iterator const_iterator;
+
+ private:
+
+  // Either allele may have been ignored by apply().
+  struct Change {
+
+    Allele removed;
+
+    Allele added;
+
+    bool erased;
+
+    bool inserted;
+
+  };
+
+  ::std::vector<value_type> m_data;
+
+  Index m_size;
+
+  DemeVector m_sizes;
+
+  ::std::size_t m_hash;
+
+  ::std::vector<Change> m_log;
+
+  // Adds or removes one copy of an allele, which must be present for
+  // erase().
+  void insert(Allele const&);
+
+  void erase(Allele const&);
+
+  bool equals(AFS const&) const;
+
+ public:
+
+  explicit ScratchAFS(AFS const&);
+
+  // Removes one copy of the first allele and adds one of the second.
+  // An empty allele, or the first allele if it is absent, is ignored
+  // as in AFS::remove() and AFS::add().
+  void apply(Allele const&, Allele const&);
+
+  // Reverts the last apply().  Does nothing if there is none.
+  void undo();
+
+  // Returns the number of changes which can be undone.
+  ::std::size_t depth() const;
+
+  // Returns a persistent copy of the current alleles.
+  AFS afs() const;
+
+  Index operator[](Allele const&) const;
+
+  Index size(Index) const;
+
+  Index size() const;
+
+  Index deme() const;
+
+  ::std::size_t hash() const;
+
+  const_iterator begin() const;
+
+  const_iterator end() const;
+
+  friend bool operator==(AFS const&, ScratchAFS const&);
+
+  friend bool operator==(ScratchAFS const&, AFS const&);
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_SCRATCH_AFS_HH
@@ -33,48 +33,50 @@
 
 #include "init.hh"
 #include "state.hh"
+#include "state_space.hh"
 #include "typedef.hh"
 #include "util.hh"
 
 namespace esf {
 
 
-namespace {
-
-
-using ::std::size_t;
-using ::std::vector;
-
-
-vector<Index> state_dim(Init&);
+State::State(Init const& init)
+    : State(::std::make_shared<StateSpace const>(init)) {}
 
-vector<Index> generate_state(Index, Index, Index);
 
-Index generate_id(vector<Index>&, Index, Index);
+State::State(Init const& init, Index id)
+    : State(::std::make_shared<StateSpace const>(init), id) {}
 
 
-}
+State::State(Init const& init, ::std::vector<Index> const& data)
+    : State(::std::make_shared<StateSpace const>(init), data) {}
 
 
-State::State(Init const& init)
-    : m_init(init), m_data(expand_init()), m_id(compute_id()) {}
+State::State(::std::shared_ptr<StateSpace const> const& space)
+    : m_space(space), m_data(expand_init()), m_id(compute_id()) {}
 
 
-State::State(Init const& init, Index id)
-    : m_init(init), m_id(id) {
+State::State(::std::shared_ptr<StateSpace const> const& space, Index id)
+    : m_space(space), m_id(id) {
 
   m_data = compute_state();
 
 }
 
 
-State::State(Init const& init, ::std::vector<Index> const& data)
-    : m_init(init), m_data(data), m_id(compute_id()) {}
+State::State(::std::shared_ptr<StateSpace const> const& space,
+             ::std::vector<Index> const& data)
+    : m_space(space), m_data(data), m_id(compute_id()) {}
+
+
+State::State(::std::shared_ptr<StateSpace const> const& space,
+             value_type const& data)
+    : m_space(space), m_data(data), m_id(compute_id()) {}
 
 
 ::std::vector<State> State::neighbors() const {
 
-  auto deme = m_init.deme();
+  auto deme = m_space->deme();
 
   using ::std::vector;
 
@@ -123,42 +125,39 @@ Index State::id() const {
 
 Index State::deme() const {
 
-  return m_init.deme();
+  return m_space ? m_space->deme() : 0;
 
 }
 
 
-Index State::operator[](Index i) const {
+::std::shared_ptr<StateSpace const> const& State::space() const {
 
-  return m_data[unsign(i)];
+  return m_space;
 
 }
 
 
-Index& State::operator[](Index i) {
+Index State::operator[](Index i) const {
 
   return m_data[unsign(i)];
 
 }
 
 
-State::value_type State::compute_state() {
-
-  auto deme = m_init.deme();
+Index& State::operator[](Index i) {
 
-  value_type data;
+  return m_data[unsign(i)];
 
-  data.reserve(unsign(deme * deme));
+}
 
-  auto idx_list = index_1_to_n(state_dim(m_init), m_id);
 
-  for (decltype(deme) i = 0; i < deme; ++i) {
+State::value_type State::compute_state() {
 
-    auto substate = generate_state(idx_list[unsign(i)], deme, m_init[i]);
+  auto deme = m_space->deme();
 
-    data.insert(data.end(), substate.begin(), substate.end());
+  value_type data(unsign(deme * deme));
 
-  }
+  m_space->decode(m_id, data.data());
 
   return data;
 
@@ -167,26 +166,16 @@ State::value_type State::compute_state() {
 
 Index State::compute_id() {
 
-  auto deme = m_init.deme();
-
-  using ::std::vector;
-
-  vector<Index> accum(unsign(deme));
-
-  for (decltype(deme) i = 0; i < deme; ++i) {
-
-    accum[unsign(i)] = generate_id(m_data, deme * i, deme * i + deme);
-
-  }
-
-  return index_n_to_1(state_dim(m_init), accum);
+  return m_space->encode(m_data.data());
 
 }
 
 
 State::value_type State::expand_init() {
 
-  auto deme = m_init.deme();
+  auto const& init = m_space->init();
+
+  auto deme = init.deme();
 
   value_type data;
 
@@ -194,7 +183,7 @@ State::value_type State::expand_init() {
 
   for (decltype(deme) i = 0; i < deme; ++i) {
 
-    data[unsign(i + i * deme)] = m_init[i];
+    data[unsign(i + i * deme)] = init[i];
 
   }
 
@@ -233,7 +222,10 @@ State::const_iterator State::end() const {
 
 bool operator==(State const& a, State const& b) {
 
-  return a.m_init == b.m_init && a.m_data == b.m_data && a.m_id == b.m_id;
+  bool same_space = a.m_space == b.m_space ||
+      (a.m_space && b.m_space && a.m_space->init() == b.m_space->init());
+
+  return same_space && a.m_data == b.m_data && a.m_id == b.m_id;
 
 }
 
@@ -245,101 +237,6 @@ bool operator<(State const& a, State const& b) {
 }
 
 
-namespace {
-
-
-::std::vector<Index> state_dim(Init& init) {
-
-  auto deme = init.deme();
-
-  ::std::vector<Index> dim(unsign(deme));
-
-  using ::std::transform;
-
-  transform(init.begin(), init.end(), dim.begin(),
-            [deme](Index i)
-            {
-              return binomial(i + deme - 1, i);
-            });
-
-  return dim;
-
-}
-
-::std::vector<Index> generate_state(Index idx, Index deme, Index gene) {
-
-  using std::vector;
-
-  Index offset = 0;
-
-  vector<Index> state(unsign(deme));
-
-  for (decltype(deme) i = 0; i < deme - 1; ++i) {
-
-    Index j = 0;
-
-    while (idx > 0 &&
-           (offset = binomial(gene - j + deme - i - 2, gene - j)) <= idx) {
-
-      idx -= offset;
-
-      ++j;
-
-    }
-
-    gene -= j;
-
-    state[unsign(i)] = j;
-
-  }
-
-  state[unsign(deme - 1)] = gene;
-
-  return state;
-
-}
-
-
-Index generate_id(::std::vector<Index>& state, Index b, Index e) {
-
-  using ::std::size_t;
-  using ::std::ptrdiff_t;
-
-  auto deme = e - b;
-
-  ptrdiff_t begin = static_cast<ptrdiff_t>(b);
-  ptrdiff_t end = static_cast<ptrdiff_t>(e);
-
-  using ::std::accumulate;
-
-  auto size = accumulate(state.begin() + begin, state.begin() + end, 0);
-
-  Index idx = 0;
-
-  for (decltype(deme) i = 0; i < deme - 1; ++i) {
-
-    auto curr = state[unsign(b)];
-
-    ++b;
-
-    for (decltype(curr) j = 0; j < curr; ++j) {
-
-      idx += binomial(size - j + deme - i - 2, size - j);
-
-    }
-
-    size -= curr;
-
-  }
-
-  return idx;
-
-}
-
-
-}
-
-
 ::std::ostream& operator<<(::std::ostream& str, State const& state) {
 
   using ::std::copy;
@@ -27,29 +27,37 @@
 #define ESF_MULTI_STATE_HH
 
 
+#include <iosfwd>
+#include <memory>
+#include <vector>
+
 #include "init.hh"
+#include "inline_vector.hh"
+#include "state_space.hh"
 
 
 namespace esf {
 
 
 // This class represents a state. States contain information of inital
-// location of genes and the current location.
+// location of genes and the current location.  The initial condition
+// is not copied into each state, and states of the same initial
+// condition share one StateSpace.
 class State {
 
  public:
 
-  typedef typename ::std::vector<Index> value_type;
+  typedef StateVector value_type;
 
-  typedef typename value_type::iterator iterator;
+  typedef value_type::iterator iterator;
 
-  typedef typename value_type::const_iterator const_iterator;
+  typedef value_type::const_iterator const_iterator;
 
   private:
 
-  Init m_init;
+  ::std::shared_ptr<StateSpace const> m_space;
 
-  ::std::vector<Index> m_data;
+  value_type m_data;
 
   Index m_id;
 
@@ -88,6 +96,16 @@ class State {
   // location and j the current location.
   State(Init const&, ::std::vector<Index> const&);
 
+  // The same as above except that the space of states is shared with
+  // other states.
+  State(::std::shared_ptr<StateSpace const> const&);
+
+  State(::std::shared_ptr<StateSpace const> const&, Index);
+
+  State(::std::shared_ptr<StateSpace const> const&, ::std::vector<Index> const&);
+
+  State(::std::shared_ptr<StateSpace const> const&, value_type const&);
+
   // Computes a list of states, which are diferent from the current
   // state by one migration event.  This excludes the currentstate itself.
   ::std::vector<State> neighbors() const;
@@ -100,6 +118,9 @@ class State {
   // Returns the number of demes.
   Index deme() const;
 
+  // Returns the space of states this state belongs to.
+  ::std::shared_ptr<StateSpace const> const& space() const;
+
   Index operator[](Index) const;
 
   Index& operator[](Index);
@@ -0,0 +1,205 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// state_cursor.cc - Sequential enumeration of states
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "state_cursor.hh"
+#include "state_space.hh"
+#include "typedef.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+StateCursor::StateCursor(StateSpace const& space, Index id)
+    : m_space(space), m_deme(space.deme()), m_id(id),
+      m_rank(unsign(m_deme)), m_data(unsign(m_deme * m_deme)),
+      m_genes(unsign(m_deme), 0) {
+
+  if (done()) {
+
+    return;
+
+  }
+
+  m_space.decode(id, m_data.data());
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    m_rank[unsign(b)] = id / m_space.stride(b) % m_space.init().dim(b);
+
+    for (decltype(m_deme) p = 0; p < m_deme; ++p) {
+
+      m_genes[unsign(p)] += m_data[unsign(b * m_deme + p)];
+
+    }
+
+  }
+
+}
+
+
+StateSpace const& StateCursor::space() const {
+
+  return m_space;
+
+}
+
+
+Index StateCursor::id() const {
+
+  return m_id;
+
+}
+
+
+bool StateCursor::done() const {
+
+  return m_id >= m_space.dim();
+
+}
+
+
+Index StateCursor::rank(Index b) const {
+
+  return m_rank[unsign(b)];
+
+}
+
+
+Index const* StateCursor::ranks() const {
+
+  return m_rank.data();
+
+}
+
+
+Index const* StateCursor::data() const {
+
+  return m_data.data();
+
+}
+
+
+Index StateCursor::operator[](Index idx) const {
+
+  return m_data[unsign(idx)];
+
+}
+
+
+Index StateCursor::genes(Index deme) const {
+
+  return m_genes[unsign(deme)];
+
+}
+
+
+StateCursor& StateCursor::operator++() {
+
+  ++m_id;
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    if (advance(b)) {
+
+      ++m_rank[unsign(b)];
+
+      break;
+
+    }
+
+    m_rank[unsign(b)] = 0;
+
+  }
+
+  return *this;
+
+}
+
+
+void StateCursor::move(Index b, Index p, Index count) {
+
+  m_data[unsign(b * m_deme + p)] += count;
+
+  m_genes[unsign(p)] += count;
+
+}
+
+
+bool StateCursor::advance(Index b) {
+
+  // Compositions are ranked in the lexicographic order of all but the
+  // last deme, which takes the remaining genes.
+  auto comp = m_data.data() + b * m_deme;
+
+  auto last = m_deme - 1;
+
+  if (last == 0) {
+
+    return false;
+
+  }
+
+  if (comp[last] > 0) {
+
+    move(b, last, -1);
+    move(b, last - 1, 1);
+
+    return true;
+
+  }
+
+  auto j = last - 1;
+
+  while (j > 0 && comp[j] == 0) {
+
+    --j;
+
+  }
+
+  auto rest = comp[j];
+
+  move(b, j, -rest);
+
+  if (j == 0) {
+
+    // The last composition has all genes in the first deme, and it is
+    // followed by the first one, which has all of them in the last.
+    move(b, last, rest);
+
+    return false;
+
+  }
+
+  move(b, j - 1, 1);
+  move(b, last, rest - 1);
+
+  return true;
+
+}
+
+
+}
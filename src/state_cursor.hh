@@ -0,0 +1,107 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// state_cursor.hh - Sequential enumeration of states
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_STATE_CURSOR_HH
+#define ESF_MULTI_STATE_CURSOR_HH
+
+#include <vector>
+
+#include "state_space.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class visits states of a space in the order of their IDs.
+//
+// It works like an odometer over compositions of demes of origin.  The
+// composition of the first origin is replaced by its successor, and the
+// next origin is advanced only when the first one wraps around.  Moving
+// to the next state therefore takes amortized constant time, and it
+// neither unranks compositions nor allocates memory.  Numbers of genes
+// in current demes are kept up to date along the way.
+//
+//     for (StateCursor c(space); !c.done(); ++c) { ... }
+class StateCursor {
+
+ private:
+
+  StateSpace const& m_space;
+
+  Index m_deme;
+
+  Index m_id;
+
+  ::std::vector<Index> m_rank;
+
+  ::std::vector<Index> m_data;
+
+  ::std::vector<Index> m_genes;
+
+  // Moves the composition of an origin to its successor.  Returns false
+  // if it wraps around to the first composition.
+  bool advance(Index);
+
+  void move(Index, Index, Index);
+
+ public:
+
+  // Starts from a state given by ID.
+  StateCursor(StateSpace const&, Index = 0);
+
+  StateCursor(StateCursor const&) = default;
+
+  ~StateCursor() = default;
+
+  StateSpace const& space() const;
+
+  Index id() const;
+
+  // Returns true once all states have been visited.
+  bool done() const;
+
+  // Returns the rank of the composition of a deme of origin.
+  Index rank(Index) const;
+
+  // Returns ranks of compositions of all demes of origin.
+  Index const* ranks() const;
+
+  // Returns numbers of genes in the layout of State.
+  Index const* data() const;
+
+  Index operator[](Index) const;
+
+  // Returns the number of genes in a current deme.
+  Index genes(Index) const;
+
+  StateCursor& operator++();
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_STATE_CURSOR_HH
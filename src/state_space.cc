@@ -0,0 +1,182 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// state_space.cc - Space of states reacheable from an initial condition
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "binomial.hh"
+#include "init.hh"
+#include "state_space.hh"
+#include "typedef.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+StateSpace::StateSpace(Init const& init)
+    : m_init(init), m_deme(init.deme()), m_dim(0),
+      m_stride(unsign(init.deme())),
+      m_binomial(init.deme(), init.deme() == 0
+                 ? 0 : *::std::max_element(init.begin(), init.end())) {
+
+  Index stride = 1;
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    m_stride[unsign(b)] = stride;
+
+    if (stride > ::std::numeric_limits<Index>::max() / m_init.dim(b)) {
+
+      throw ::std::overflow_error("number of states does not fit in Index");
+
+    }
+
+    stride *= m_init.dim(b);
+
+  }
+
+  m_dim = stride;
+
+}
+
+
+Init const& StateSpace::init() const {
+
+  return m_init;
+
+}
+
+
+Index StateSpace::deme() const {
+
+  return m_deme;
+
+}
+
+
+Index StateSpace::dim() const {
+
+  return m_dim;
+
+}
+
+
+Index StateSpace::stride(Index b) const {
+
+  return m_stride[unsign(b)];
+
+}
+
+
+void StateSpace::decode(Index id, Index* data) const {
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    auto r = id / m_stride[unsign(b)] % m_init.dim(b);
+
+    unrank(r, m_init[b], data + b * m_deme);
+
+  }
+
+}
+
+
+Index StateSpace::encode(Index const* data) const {
+
+  Index id = 0;
+
+  for (decltype(m_deme) b = 0; b < m_deme; ++b) {
+
+    id += m_stride[unsign(b)] * rank(data + b * m_deme);
+
+  }
+
+  return id;
+
+}
+
+
+Index StateSpace::rank(Index const* comp) const {
+
+  Index size = 0;
+
+  for (decltype(m_deme) i = 0; i < m_deme; ++i) {
+
+    size += comp[i];
+
+  }
+
+  Index idx = 0;
+
+  for (decltype(m_deme) i = 0; i < m_deme - 1; ++i) {
+
+    auto curr = comp[i];
+
+    for (decltype(curr) j = 0; j < curr; ++j) {
+
+      idx += m_binomial(size - j + m_deme - i - 2, size - j);
+
+    }
+
+    size -= curr;
+
+  }
+
+  return idx;
+
+}
+
+
+void StateSpace::unrank(Index idx, Index gene, Index* comp) const {
+
+  Index offset = 0;
+
+  for (decltype(m_deme) i = 0; i < m_deme - 1; ++i) {
+
+    Index j = 0;
+
+    while (idx > 0 &&
+           (offset = m_binomial(gene - j + m_deme - i - 2, gene - j)) <= idx) {
+
+      idx -= offset;
+
+      ++j;
+
+    }
+
+    gene -= j;
+
+    comp[i] = j;
+
+  }
+
+  comp[m_deme - 1] = gene;
+
+}
+
+
+}
@@ -0,0 +1,107 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// state_space.hh - Space of states reacheable from an initial condition
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef ESF_MULTI_STATE_SPACE_HH
+#define ESF_MULTI_STATE_SPACE_HH
+
+#include <vector>
+
+#include "binomial.hh"
+#include "init.hh"
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class describes all states reacheable from an initial
+// condition.  It is immutable, and it is meant to be shared by all
+// states of the same initial condition instead of each state holding
+// its own copy of the initial condition.
+//
+// A state is a tuple of compositions, one for each deme of origin,
+// and its ID is a mixed-radix number whose digits are ranks of the
+// compositions.  The digit of the first origin changes most rapidly.
+// Conversion between IDs and states does not allocate memory, and it
+// looks up binomial coefficients in a table sized from the initial
+// condition.  Construction throws ::std::overflow_error if IDs do not
+// fit in Index.
+class StateSpace {
+
+ private:
+
+  Init m_init;
+
+  Index m_deme;
+
+  Index m_dim;
+
+  ::std::vector<Index> m_stride;
+
+  BinomialTable m_binomial;
+
+ public:
+
+  StateSpace(Init const&);
+
+  StateSpace(StateSpace const&) = default;
+
+  StateSpace& operator=(StateSpace const&) = default;
+
+  ~StateSpace() = default;
+
+  Init const& init() const;
+
+  // Returns the number of demes.
+  Index deme() const;
+
+  // Returns the total number of states.
+  Index dim() const;
+
+  // Returns the difference of IDs between two states, whose ranks of
+  // compositions differ by one in a specified deme of origin.
+  Index stride(Index) const;
+
+  // Writes the numbers of genes of a state into a buffer of length
+  // n^2 for n the number of demes.  The order is the same as that of
+  // State.
+  void decode(Index, Index*) const;
+
+  // Returns ID of a state given as a buffer of the same layout.
+  Index encode(Index const*) const;
+
+  // Returns the rank of a composition of genes over n demes.  The
+  // rank does not depend on the deme of origin.
+  Index rank(Index const*) const;
+
+  // Writes a composition of specified number of genes and rank into a
+  // buffer of length n.
+  void unrank(Index, Index, Index*) const;
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_STATE_SPACE_HH
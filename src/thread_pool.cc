@@ -0,0 +1,336 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// thread_pool.cc - Pool of worker threads
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.hh"
+#include "util.hh"
+
+namespace esf {
+
+
+ThreadPool::ThreadPool(Index threads)
+    : m_stop(false) {
+
+  if (threads <= 0) {
+
+    threads = ::std::max<Index>(1, ::std::thread::hardware_concurrency());
+
+  }
+
+  for (Index i = 1; i < threads; ++i) {
+
+    m_workers.emplace_back(&ThreadPool::work, this);
+
+  }
+
+}
+
+
+ThreadPool::~ThreadPool() {
+
+  {
+
+    ::std::lock_guard<::std::mutex> lock(m_mutex);
+
+    m_stop = true;
+
+  }
+
+  m_cond.notify_all();
+
+  for (auto& worker: m_workers) {
+
+    worker.join();
+
+  }
+
+}
+
+
+Index ThreadPool::size() const {
+
+  return sign(m_workers.size()) + 1;
+
+}
+
+
+void ThreadPool::parallel_for(Index begin, Index end, Index chunk,
+                              ::std::function<void(Index, Index)> const& f) {
+
+  if (begin >= end) {
+
+    return;
+
+  }
+
+  chunk = ::std::max<Index>(1, chunk);
+
+  Index nchunk = (end - begin + chunk - 1) / chunk;
+
+  ::std::atomic<Index> next(0);
+
+  ::std::atomic<bool> failed(false);
+
+  auto loop = [&]() {
+
+    for (Index c = next++; c < nchunk && !failed; c = next++) {
+
+      Index b = begin + c * chunk;
+
+      f(b, ::std::min(b + chunk, end));
+
+    }
+
+  };
+
+  run(::std::min(sign(m_workers.size()), nchunk - 1),
+      [&loop](Index) { loop(); }, failed);
+
+}
+
+
+void ThreadPool::parallel_for_each(Index begin, Index end,
+                                   ::std::function<void(Index)> const& f) {
+
+  if (begin >= end) {
+
+    return;
+
+  }
+
+  // Remaining indices of a thread.
+  struct Range {
+
+    ::std::mutex mutex;
+
+    Index begin;
+
+    Index end;
+
+  };
+
+  auto parts = ::std::min(size(), end - begin);
+
+  ::std::unique_ptr<Range[]> ranges(new Range[unsign(parts)]);
+
+  for (Index i = 0; i < parts; ++i) {
+
+    auto& r = ranges[unsign(i)];
+
+    r.begin = begin + (end - begin) * i / parts;
+    r.end = begin + (end - begin) * (i + 1) / parts;
+
+  }
+
+  ::std::atomic<bool> failed(false);
+
+  auto loop = [&](Index self) {
+
+    auto& own = ranges[unsign(self)];
+
+    while (!failed) {
+
+      Index idx = -1;
+
+      {
+
+        ::std::lock_guard<::std::mutex> lock(own.mutex);
+
+        if (own.begin < own.end) {
+
+          idx = own.begin++;
+
+        }
+
+      }
+
+      if (idx >= 0) {
+
+        f(idx);
+
+        continue;
+
+      }
+
+      Index lo = 0, hi = 0;
+
+      for (Index k = 1; k < parts && lo == hi; ++k) {
+
+        auto& victim = ranges[unsign((self + k) % parts)];
+
+        ::std::lock_guard<::std::mutex> lock(victim.mutex);
+
+        auto rest = victim.end - victim.begin;
+
+        if (rest > 0) {
+
+          lo = victim.end - (rest + 1) / 2;
+          hi = victim.end;
+
+          victim.end = lo;
+
+        }
+
+      }
+
+      if (lo == hi) {
+
+        return;
+
+      }
+
+      ::std::lock_guard<::std::mutex> lock(own.mutex);
+
+      own.begin = lo;
+      own.end = hi;
+
+    }
+
+  };
+
+  run(parts - 1, loop, failed);
+
+}
+
+
+void ThreadPool::run(Index helpers, ::std::function<void(Index)> const& f,
+                     ::std::atomic<bool>& failed) {
+
+  // Number of helpers which have not finished yet, and the first
+  // exception thrown.  Both are guarded by the mutex of the pool.
+  Index running = helpers;
+
+  ::std::exception_ptr error;
+
+  ::std::condition_variable done;
+
+  // No call may unwind past this function while helpers still refer
+  // to its locals.
+  auto call = [&](Index i) {
+
+    try {
+
+      f(i);
+
+    } catch (...) {
+
+      failed = true;
+
+      ::std::lock_guard<::std::mutex> lock(m_mutex);
+
+      if (!error) {
+
+        error = ::std::current_exception();
+
+      }
+
+    }
+
+  };
+
+  {
+
+    ::std::lock_guard<::std::mutex> lock(m_mutex);
+
+    for (Index i = 1; i <= helpers; ++i) {
+
+      m_tasks.emplace_back([&, i]() {
+
+          call(i);
+
+          ::std::lock_guard<::std::mutex> lock(m_mutex);
+
+          if (--running == 0) {
+
+            done.notify_one();
+
+          }
+
+        });
+
+    }
+
+  }
+
+  m_cond.notify_all();
+
+  call(0);
+
+  ::std::unique_lock<::std::mutex> lock(m_mutex);
+
+  done.wait(lock, [&running]() { return running == 0; });
+
+  if (error) {
+
+    lock.unlock();
+
+    ::std::rethrow_exception(error);
+
+  }
+
+}
+
+
+void ThreadPool::work() {
+
+  for (;;) {
+
+    ::std::function<void()> task;
+
+    {
+
+      ::std::unique_lock<::std::mutex> lock(m_mutex);
+
+      m_cond.wait(lock, [this]() { return m_stop || !m_tasks.empty(); });
+
+      if (m_stop && m_tasks.empty()) {
+
+        return;
+
+      }
+
+      task = ::std::move(m_tasks.front());
+
+      m_tasks.pop_front();
+
+    }
+
+    task();
+
+  }
+
+}
+
+
+}
@@ -0,0 +1,109 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// thread_pool.hh - Pool of worker threads
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+#ifndef ESF_MULTI_THREAD_POOL_HH
+#define ESF_MULTI_THREAD_POOL_HH
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "typedef.hh"
+
+namespace esf {
+
+
+// This class keeps a fixed number of threads, and it runs loops on
+// them.  The thread calling parallel_for takes part in the loop, so a
+// pool of n threads starts n - 1 workers.  A pool of single thread
+// runs everything on the calling thread.  Loops must not be nested on
+// the same pool.
+//
+// A loop body may throw.  Then no more indices are handed out, calls
+// in progress on other threads are waited for, and the first exception
+// is rethrown on the calling thread.  Indices already taken by other
+// threads may still be processed.
+class ThreadPool {
+
+ private:
+
+  ::std::vector<::std::thread> m_workers;
+
+  ::std::deque<::std::function<void()>> m_tasks;
+
+  ::std::mutex m_mutex;
+
+  ::std::condition_variable m_cond;
+
+  bool m_stop;
+
+  void work();
+
+  // Calls the function with 0 on the calling thread and with 1, ...,
+  // n on n workers, and waits until all calls return.  If a call
+  // throws, the flag is set so that loops stop taking indices, and the
+  // first exception is rethrown after all calls return.
+  void run(Index, ::std::function<void(Index)> const&, ::std::atomic<bool>&);
+
+ public:
+
+  // Creates a pool with the specified number of threads.  Zero means
+  // the number of hardware threads.
+  explicit ThreadPool(Index = 0);
+
+  ThreadPool(ThreadPool const&) = delete;
+
+  ThreadPool& operator=(ThreadPool const&) = delete;
+
+  ~ThreadPool();
+
+  // Returns the number of threads including the calling thread.
+  Index size() const;
+
+  // Divides [begin, end) into chunks of specified length, and calls
+  // the function with the bounds of each chunk.  This function
+  // returns when all chunks are processed.  Chunks are processed
+  // concurrently.
+  void parallel_for(Index, Index, Index,
+                    ::std::function<void(Index, Index)> const&);
+
+  // Calls the function with every index in [begin, end) and returns
+  // when all calls are done.  The range is split evenly among threads
+  // at first.  A thread, which runs out of indices, steals the upper
+  // half of the remaining indices of another thread.  This balances
+  // load when costs of indices vary widely, while each thread still
+  // walks through mostly contiguous indices.
+  void parallel_for_each(Index, Index, ::std::function<void(Index)> const&);
+
+};
+
+
+}
+
+
+#endif // ESF_MULTI_THREAD_POOL_HH
@@ -27,10 +27,14 @@
 #define ESF_MULTI_UTIL_HH
 
 #include <functional>
+#include <limits>
 #include <numeric>
+#include <stdexcept>
 #include <type_traits>
 #include <vector>
 
+#include "binomial.hh"
+
 
 namespace esf {
 
@@ -56,7 +60,9 @@ template <typename T,
           class = typename enable_if<is_integral<T>::value>::type>
 typename make_unsigned<T>::type unsign(T val);
 
-// Compute binomial coefficient.
+// Compute binomial coefficient.  Small arguments are looked up in a
+// table, and ::std::overflow_error is thrown if the value does not fit
+// in T.
 template <typename T,
           class = typename enable_if<is_integral<T>::value>::type>
 T binomial(T n, T k);
@@ -119,18 +125,52 @@ vector<T> mult_factors(vector<T> const& dim) {
 template <typename T, class>
 T binomial(T n, T k) {
 
-  T value = 1;
+  if (k < 0 || k > n) {
+
+    return 0;
+
+  }
+
+  if (n < small_binomial_size) {
 
-  if (k > n - k && n - k >= 0) {
+    return static_cast<T>(small_binomial(static_cast<Index>(n),
+                                          static_cast<Index>(k)));
+
+  }
+
+  if (k > n - k) {
 
     k = n - k;
 
   }
 
+  // C(n, i + 1) = C(n, i) * (n - i) / (i + 1) is split into quotient
+  // and remainder of C(n, i) so that no intermediate value exceeds the
+  // result by more than a factor of n.
+  T value = 1;
+
   for (T i = 0; i < k; ++i) {
 
-    value *= (n - i);
-    value /= (i + 1);
+    T q = value / (i + 1);
+    T r = value % (i + 1);
+
+    if (q > ::std::numeric_limits<T>::max() / (n - i)) {
+
+      throw ::std::overflow_error("binomial coefficient does not fit");
+
+    }
+
+    value = q * (n - i);
+
+    T rest = r * (n - i) / (i + 1);
+
+    if (value > ::std::numeric_limits<T>::max() - rest) {
+
+      throw ::std::overflow_error("binomial coefficient does not fit");
+
+    }
+
+    value += rest;
 
   }
 
@@ -147,13 +187,15 @@ T index_n_to_1(vector<T> const& dim, vector<T> const& idx) {
 
   typename vector<T>::size_type size = dim.size();
 
-  auto accum = mult_factors(dim);
+  T accum = 1;
 
   T value = 0;
 
   for (decltype(size) i = 0; i < size; ++i) {
 
-    value += idx[i] * accum[i];
+    value += idx[i] * accum;
+
+    accum *= dim[i];
 
   }
 
@@ -168,13 +210,13 @@ vector<T> index_1_to_n(vector<T> const& dim, T idx) {
 
   typename vector<T>::size_type size = dim.size();
 
-  auto accum = mult_factors(dim);
-
   vector<T> values(size);
 
   for (decltype(size) i = 0; i < size; ++i) {
 
-    values[i] = (idx / accum[i]) % dim[i];
+    values[i] = idx % dim[i];
+
+    idx /= dim[i];
 
   }
 
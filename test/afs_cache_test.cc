@@ -0,0 +1,138 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// afs_cache_test.cc - [unit test] afs_cache
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cmath>
+#include <functional>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_cache.hh"
+#include "allele.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::AFS;
+using ::esf::AFSCache;
+using ::esf::Allele;
+using ::std::vector;
+
+
+class AFSCacheTest: public ::testing::Test {
+
+ protected:
+
+  AFSCacheTest()
+      : root(vector<Allele>({Allele({2, 0})})), cache(root) {}
+
+  AFS root;
+
+  AFSCache cache;
+
+};
+
+
+TEST_F(AFSCacheTest, GetOrCompute) {
+
+  int calls = 0;
+
+  auto fn = [&calls]() { ++calls; return 0.5; };
+
+  EXPECT_EQ(nullptr, cache.find(root));
+
+  EXPECT_DOUBLE_EQ(0.5, cache.get_or_compute(root, fn));
+  EXPECT_DOUBLE_EQ(0.5, cache.get_or_compute(root, fn));
+
+  EXPECT_EQ(1, calls);
+
+  ASSERT_NE(nullptr, cache.find(root));
+  EXPECT_DOUBLE_EQ(0.5, *cache.find(root));
+
+  auto stats = cache.stats();
+
+  EXPECT_EQ(3u, stats.hits);
+  EXPECT_EQ(2u, stats.misses);
+  EXPECT_EQ(1u, stats.inserts);
+  EXPECT_EQ(1u, stats.size);
+
+}
+
+
+TEST_F(AFSCacheTest, GetOrComputeNaN) {
+
+  int calls = 0;
+
+  auto fn = [&calls]() { ++calls; return ::std::nan(""); };
+
+  EXPECT_TRUE(::std::isnan(cache.get_or_compute(root, fn)));
+  EXPECT_TRUE(::std::isnan(cache.get_or_compute(root, fn)));
+
+  // NaN is a value like any other, and it is not computed again.
+  EXPECT_EQ(1, calls);
+
+  ASSERT_NE(nullptr, cache.find(root));
+
+}
+
+
+TEST_F(AFSCacheTest, GetOrComputeRecursively) {
+
+  // Interning more AFS during fn() keeps earlier IDs.
+  ::std::function<double(int)> count = [&](int n) {
+
+    AFS afs(vector<Allele>({Allele({n, 1})}));
+
+    return cache.get_or_compute(afs, [&]() {
+
+        return n == 0 ? 0.0 : count(n - 1) + 1.0;
+
+      });
+
+  };
+
+  EXPECT_DOUBLE_EQ(30.0, count(30));
+  EXPECT_EQ(31u, cache.stats().size);
+  EXPECT_EQ(31u, cache.table().size());
+
+  auto id = cache.intern(AFS(vector<Allele>({Allele({5, 1})})));
+
+  EXPECT_EQ(25u, id);
+  EXPECT_DOUBLE_EQ(5.0, *cache.find(cache.table()[id]));
+
+}
+
+
+TEST_F(AFSCacheTest, InternWithoutValue) {
+
+  cache.intern(root);
+
+  EXPECT_EQ(1u, cache.table().size());
+  EXPECT_EQ(nullptr, cache.find(root));
+  EXPECT_EQ(0u, cache.stats().inserts);
+
+}
+
+
+}
@@ -0,0 +1,146 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// afs_table_test.cc - [unit test] afs_table
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <stdexcept>
+#include <vector>
+
+#include "afs.hh"
+#include "afs_table.hh"
+#include "allele.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::AFS;
+using ::esf::AFSTable;
+using ::esf::Allele;
+using ::std::vector;
+
+
+TEST(AFSTableTest, Intern) {
+
+  AFSTable table;
+
+  AFS a0(vector<Allele>({Allele({1, 0}), Allele({0, 1})}));
+  AFS a1(vector<Allele>({Allele({0, 1}), Allele({1, 0})}));
+  AFS a2(vector<Allele>({Allele({1, 1})}));
+
+  EXPECT_EQ(AFSTable::npos, table.find(a0));
+
+  EXPECT_EQ(0u, table.intern(a0));
+  EXPECT_EQ(0u, table.intern(a1));
+  EXPECT_EQ(1u, table.intern(a2));
+
+  EXPECT_EQ(0u, table.find(a1));
+  EXPECT_EQ(2u, table.size());
+  EXPECT_EQ(a2, table[1]);
+
+}
+
+
+TEST(AFSTableTest, Grow) {
+
+  AFSTable table;
+
+  vector<AFS> samples;
+
+  for (int i = 1; i <= 20; ++i) {
+
+    for (int j = 0; j <= 10; ++j) {
+
+      samples.push_back(AFS(vector<Allele>({Allele({i, j}), Allele({0, 1})})));
+
+    }
+
+  }
+
+  for (decltype(samples.size()) i = 0; i < samples.size(); ++i) {
+
+    EXPECT_EQ(i, table.intern(samples[i]));
+
+  }
+
+  // IDs are kept as the table grows.
+  for (decltype(samples.size()) i = 0; i < samples.size(); ++i) {
+
+    EXPECT_EQ(i, table.find(samples[i]));
+    EXPECT_EQ(samples[i], table[static_cast<AFSTable::id_type>(i)]);
+
+  }
+
+  EXPECT_GE(table.slots(), 2 * table.size());
+
+}
+
+
+TEST(AFSTableTest, Diagnostics) {
+
+  AFSTable table;
+
+  for (int i = 1; i <= 50; ++i) {
+
+    table.intern(AFS(vector<Allele>({Allele({i, 1})})));
+
+  }
+
+  auto diag = table.diagnostics();
+
+  EXPECT_EQ(50u, diag.keys);
+  EXPECT_EQ(table.slots(), diag.buckets);
+
+  ::std::size_t keys = 0;
+
+  for (::std::size_t i = 0; i < diag.bucket_lengths.size(); ++i) {
+
+    keys += i * diag.bucket_lengths[i];
+
+  }
+
+  EXPECT_EQ(diag.keys, keys);
+  EXPECT_DOUBLE_EQ(0.0, diag.hash_collision_rate);
+  EXPECT_LE(1.0, diag.mean_probe);
+
+}
+
+
+TEST(AFSTableTest, StableReference) {
+
+  AFSTable table;
+
+  auto const& first = table[table.intern(AFS(vector<Allele>({Allele({1, 1})})))];
+
+  for (int i = 1; i <= 100; ++i) {
+
+    table.intern(AFS(vector<Allele>({Allele({i, 2})})));
+
+  }
+
+  EXPECT_EQ(&first, &table[0]);
+  EXPECT_EQ(AFS(vector<Allele>({Allele({1, 1})})), first);
+
+}
+
+
+}
@@ -162,8 +162,6 @@ TEST_F(AFSTest, AllReacheable) {
 
   auto test = AFS(v1).reacheable();
 
-  using ::std::vector;
-
   Init init({1, 1});
 
   vector<ExitAFSPair> exp =
@@ -208,4 +206,76 @@ TEST_F(AFSTest, AllReacheable) {
 }
 
 
+
+TEST_F(AFSTest, SortedAndCached) {
+
+  ::esf::AFS other({a002, a010, a100, a100});
+
+  EXPECT_EQ(s, other);
+  EXPECT_EQ(s.hash(), other.hash());
+  EXPECT_EQ(::std::hash<::esf::AFS>()(s), s.hash());
+
+  EXPECT_TRUE(::std::is_sorted(s.begin(), s.end()));
+
+  auto t = s.add(a020).remove(a100).remove(a100);
+
+  EXPECT_TRUE(::std::is_sorted(t.begin(), t.end()));
+  EXPECT_EQ(3, ::std::distance(t.begin(), t.end()));
+
+  EXPECT_EQ(5, t.size());
+  EXPECT_EQ(0, t.size(0));
+  EXPECT_EQ(3, t.size(1));
+  EXPECT_EQ(2, t.size(2));
+
+  EXPECT_EQ(t, ::esf::AFS({a010, a020, a002}));
+
+  // Removing an absent allele or adding an empty one has no effect.
+  EXPECT_EQ(t, t.remove(a200));
+  EXPECT_EQ(t, t.add(::esf::Allele({0, 0, 0})));
+
+  auto empty = c0.remove(a100).remove(a100);
+
+  EXPECT_EQ(0, empty.size());
+  EXPECT_EQ(3, empty.deme());
+
+}
+
+
+TEST_F(AFSTest, ReacheableVisitor) {
+
+  using ::esf::AFS;
+  using ::esf::State;
+
+  AFS afs({a200, a020, a100, a010});
+
+  auto expected = afs.reacheable();
+
+  ::std::size_t i = 0;
+
+  afs.reacheable([&](AFS const& exit, State const& state)
+                 {
+                   ASSERT_LT(i, expected.size());
+
+                   EXPECT_EQ(expected[i].afs, exit);
+                   EXPECT_EQ(expected[i].state, state);
+                   EXPECT_EQ(expected[i].state.id(), state.id());
+
+                   ++i;
+                 });
+
+  EXPECT_EQ(expected.size(), i);
+
+}
+
+
+TEST_F(AFSTest, Layer) {
+
+  using ::esf::AFS;
+
+  EXPECT_EQ(AFS::layer_type(5, 3), s.layer());
+  EXPECT_EQ(AFS::layer_type(6, 0), ns.layer());
+  EXPECT_EQ(AFS::layer_type(5, 1), AFS({a200, a020, a100}).layer());
+
+}
+
 }  // namespace
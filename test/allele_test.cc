@@ -153,4 +153,27 @@ TEST_F(AlleleTest, ReacheableAlleles) {
 }
 
 
+TEST_F(AlleleTest, ReacheableMemoized) {
+
+  using ::esf::Allele;
+
+  ::esf::AlleleExitCache cache;
+
+  Allele allele({2, 1});
+
+  auto const& pairs = allele.reacheable(cache);
+
+  EXPECT_EQ(&pairs, &Allele({2, 1}).reacheable(cache));
+  EXPECT_NE(&pairs, &Allele({1, 2}).reacheable(cache));
+  EXPECT_EQ(allele.reacheable(), pairs);
+
+  // Each cache keeps its own lists.
+  ::esf::AlleleExitCache other;
+
+  EXPECT_NE(&pairs, &allele.reacheable(other));
+  EXPECT_EQ(1u, cache.stats().hits);
+
+}
+
+
 }  // namespace
@@ -0,0 +1,108 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// binomial_test.cc - [unit test] binomial
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <stdexcept>
+
+#include "binomial.hh"
+#include "typedef.hh"
+#include "util.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::BinomialTable;
+using ::esf::Index;
+
+
+class BinomialTest: public ::testing::Test {
+
+ protected:
+
+  BinomialTest() {}
+
+};
+
+
+// Pascal's rule without any table.
+Index pascal(Index n, Index k) {
+
+  return k == 0 || k == n ? 1 : pascal(n - 1, k - 1) + pascal(n - 1, k);
+
+}
+
+
+TEST_F(BinomialTest, SmallTableIsConstant) {
+
+  static_assert(::esf::small_binomial(5, 2) == 10, "C(5, 2)");
+  static_assert(::esf::small_binomial(33, 16) == 1166803110, "C(33, 16)");
+  static_assert(::esf::small_binomial(3, 4) == 0, "C(3, 4)");
+
+  for (Index n = 0; n < 20; ++n) {
+
+    for (Index k = 0; k <= n; ++k) {
+
+      EXPECT_EQ(pascal(n, k), ::esf::small_binomial(n, k));
+
+    }
+
+  }
+
+}
+
+
+TEST_F(BinomialTest, Table) {
+
+  BinomialTable table(4, 60);
+
+  for (Index a = 0; a < 4; ++a) {
+
+    for (Index k = 0; k <= 60; ++k) {
+
+      EXPECT_EQ(::esf::binomial(a + k, k), table(a + k, k));
+
+    }
+
+  }
+
+  EXPECT_EQ(0, table(2, 3));
+  EXPECT_EQ(::esf::binomial<Index>(40, 20), table(40, 20));
+
+}
+
+
+TEST_F(BinomialTest, Overflow) {
+
+  EXPECT_EQ(7219428434016265740L, ::esf::binomial<Index>(66, 33));
+
+  EXPECT_THROW(::esf::binomial<Index>(67, 33), ::std::overflow_error);
+
+  EXPECT_NO_THROW(BinomialTable(34, 33));
+
+  EXPECT_THROW(BinomialTable(35, 33), ::std::overflow_error);
+
+}
+
+
+}
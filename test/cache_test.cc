@@ -0,0 +1,139 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// cache_test.cc - [unit test] cache
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+#include "cache.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+typedef ::esf::Cache<int, ::std::string> Cache;
+
+
+class CacheTest: public ::testing::Test {
+
+ protected:
+
+  CacheTest()
+      : root(0), cache(root) {}
+
+  int root;
+
+  Cache cache;
+
+};
+
+
+TEST_F(CacheTest, Find) {
+
+  EXPECT_EQ(nullptr, cache.find(1));
+
+  cache[1] = "one";
+
+  ASSERT_NE(nullptr, cache.find(1));
+  EXPECT_EQ("one", *cache.find(1));
+
+  auto stats = cache.stats();
+
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+
+}
+
+
+TEST_F(CacheTest, TryEmplace) {
+
+  auto r0 = cache.try_emplace(1, "one");
+
+  EXPECT_TRUE(r0.second);
+  EXPECT_EQ("one", *r0.first);
+
+  auto r1 = cache.try_emplace(1, "uno");
+
+  EXPECT_FALSE(r1.second);
+  EXPECT_EQ("one", *r1.first);
+
+  EXPECT_EQ(1u, cache.stats().inserts);
+  EXPECT_EQ(1u, cache.stats().size);
+
+}
+
+
+TEST_F(CacheTest, GetOrCompute) {
+
+  int calls = 0;
+
+  auto fn = [&calls]() { ++calls; return ::std::string("two"); };
+
+  EXPECT_EQ("two", cache.get_or_compute(2, fn));
+  EXPECT_EQ("two", cache.get_or_compute(2, fn));
+
+  EXPECT_EQ(1, calls);
+
+  auto stats = cache.stats();
+
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.inserts);
+  EXPECT_LE(1u, stats.buckets);
+
+}
+
+
+TEST_F(CacheTest, GetOrComputeRecursively) {
+
+  // Values computed by recursion are cached along the way.
+  ::std::function<::std::string const&(int)> count = [&](int n) -> ::std::string const& {
+
+    return cache.get_or_compute(n, [&]() {
+
+        return n == 0 ? ::std::string() : count(n - 1) + "x";
+
+      });
+
+  };
+
+  EXPECT_EQ("xxxxxxxxxx", count(10));
+  EXPECT_EQ(11u, cache.stats().size);
+  EXPECT_EQ("xxxxx", *cache.find(5));
+
+}
+
+
+TEST_F(CacheTest, GetOrComputeThrows) {
+
+  EXPECT_THROW(cache.get_or_compute(3, []() -> ::std::string {
+        throw ::std::runtime_error("failure");
+      }), ::std::runtime_error);
+
+  EXPECT_EQ(nullptr, cache.find(3));
+
+}
+
+
+}
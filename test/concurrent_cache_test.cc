@@ -0,0 +1,142 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// concurrent_cache_test.cc - [unit test] concurrent_cache
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "concurrent_cache.hh"
+#include "thread_pool.hh"
+#include "typedef.hh"
+#include "util.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Index;
+
+typedef ::esf::ConcurrentCache<int, ::std::string> Cache;
+
+
+class ConcurrentCacheTest: public ::testing::Test {
+
+ protected:
+
+  ConcurrentCacheTest() {}
+
+};
+
+
+TEST_F(ConcurrentCacheTest, GetOrCompute) {
+
+  Cache cache(4);
+
+  EXPECT_EQ(4u, cache.shards());
+
+  EXPECT_EQ(nullptr, cache.find(1));
+
+  auto const& one = cache.get_or_compute(1, []() { return ::std::string("one"); });
+
+  EXPECT_EQ("one", one);
+  EXPECT_EQ(&one, cache.find(1));
+
+  EXPECT_EQ("one", cache.get_or_compute(1, []() { return ::std::string("uno"); }));
+
+  auto stats = cache.stats();
+
+  EXPECT_EQ(1u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+  EXPECT_EQ(1u, stats.inserts);
+  EXPECT_EQ(1u, stats.size);
+
+  cache.clear();
+
+  EXPECT_EQ(nullptr, cache.find(1));
+
+}
+
+
+TEST_F(ConcurrentCacheTest, ComputeOnce) {
+
+  Cache cache;
+
+  ::std::atomic<int> calls(0);
+
+  ::esf::ThreadPool pool(8);
+
+  ::std::vector<::std::string const*> values(64);
+
+  pool.parallel_for_each(
+      0, 64,
+      [&](Index i)
+      {
+        values[::esf::unsign(i)] = &cache.get_or_compute(
+            static_cast<int>(i % 4),
+            [&calls, i]()
+            {
+              ++calls;
+
+              ::std::this_thread::sleep_for(::std::chrono::milliseconds(2));
+
+              return ::std::to_string(i % 4);
+            });
+      });
+
+  EXPECT_EQ(4, calls);
+
+  for (Index i = 0; i < 64; ++i) {
+
+    EXPECT_EQ(::std::to_string(i % 4), *values[::esf::unsign(i)]);
+    EXPECT_EQ(values[::esf::unsign(i % 4)], values[::esf::unsign(i)]);
+
+  }
+
+  auto stats = cache.stats();
+
+  EXPECT_EQ(60u, stats.hits);
+  EXPECT_EQ(4u, stats.inserts);
+
+}
+
+
+TEST_F(ConcurrentCacheTest, Throw) {
+
+  Cache cache;
+
+  EXPECT_THROW(cache.get_or_compute(3, []() -> ::std::string {
+        throw ::std::runtime_error("failure");
+      }), ::std::runtime_error);
+
+  EXPECT_EQ(nullptr, cache.find(3));
+
+  EXPECT_EQ("three", cache.get_or_compute(3, []() { return ::std::string("three"); }));
+
+}
+
+
+}
@@ -0,0 +1,168 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_engine_test.cc - [unit test] ESFEngine
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "concurrent_cache.hh"
+#include "esf_engine.hh"
+#include "esf_prob.hh"
+#include "hit_prob.hh"
+#include "init.hh"
+#include "param.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Allele;
+using ::esf::AFS;
+using ::esf::ESFEngine;
+using ::esf::ESFProb;
+using ::esf::Param;
+using vector = ::std::vector<Allele>;
+
+
+class ESFEngineTest: public ::testing::Test {
+
+ protected:
+
+  ESFEngineTest()
+      : samples({AFS(vector({Allele({1, 0})})),
+                 AFS(vector({Allele({1, 0}), Allele({0, 1})})),
+                 AFS(vector({Allele({1, 0}), Allele({1, 0}), Allele({1, 0})})),
+                 AFS(vector({Allele({2, 0}), Allele({0, 1})})),
+                 AFS(vector({Allele({3, 0})})),
+                 AFS(vector({Allele({2, 1}), Allele({1, 1}), Allele({0, 1})})),
+                 AFS(vector({Allele({3, 2}), Allele({1, 0})}))}),
+        p({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4}) {}
+
+  ::std::vector<AFS> samples;
+  Param p;
+
+};
+
+
+TEST_F(ESFEngineTest, SameAsRecursion) {
+
+  ESFEngine engine(p);
+
+  for (auto const& afs: samples) {
+
+    ESFProb prob(afs, p);
+
+    EXPECT_EQ(prob.compute(), engine.compute(afs));
+
+  }
+
+  EXPECT_DOUBLE_EQ(1.0, engine.compute(samples[0]));
+  EXPECT_EQ(1, engine.nodes());
+
+}
+
+
+TEST_F(ESFEngineTest, Nodes) {
+
+  ESFEngine engine(p);
+
+  ESFProb prob(samples[6], p);
+
+  EXPECT_EQ(prob.compute(), engine.compute(samples[6]));
+
+  EXPECT_EQ(::esf::Index(prob.esf_prob_cache_stats().size), engine.nodes());
+
+}
+
+
+TEST_F(ESFEngineTest, Threads) {
+
+  ESFEngine serial(p), parallel(p, ::esf::SolverOption(), 4);
+
+  EXPECT_EQ(1, serial.threads());
+  EXPECT_EQ(4, parallel.threads());
+
+  for (auto const& afs: samples) {
+
+    EXPECT_EQ(serial.compute(afs), parallel.compute(afs));
+
+    EXPECT_EQ(serial.nodes(), parallel.nodes());
+
+  }
+
+}
+
+
+TEST_F(ESFEngineTest, MatrixFreeThreads) {
+
+  using ::esf::SolverOption;
+  using ::esf::SolverType;
+
+  SolverOption option(SolverType::MatrixFree, 1.0e-13);
+
+  // A sample without singletons solves its own initial condition.
+  AFS afs(vector({Allele({2, 1}), Allele({1, 1})}));
+
+  ::esf::ConcurrentCache<::esf::Init, ::esf::HitProb> c1, c4;
+
+  auto expected = ::esf::ESFProb(afs, p).compute();
+
+  EXPECT_NEAR(expected, ESFEngine(p, option, 1, &c1).compute(afs), 1e-10 * expected);
+  EXPECT_NEAR(expected, ESFEngine(p, option, 4, &c4).compute(afs), 1e-10 * expected);
+
+  // Solves on threads of the engine do not start threads of their own.
+  ::esf::Init init(afs);
+
+  ASSERT_NE(nullptr, c1.find(init));
+  ASSERT_NE(nullptr, c4.find(init));
+
+  EXPECT_EQ(0, c1.find(init)->option().threads);
+  EXPECT_EQ(1, c4.find(init)->option().threads);
+
+}
+
+
+TEST_F(ESFEngineTest, SharedHitProbCache) {
+
+  ::esf::ConcurrentCache<::esf::Init, ::esf::HitProb> cache;
+
+  ESFEngine e0(p, ::esf::SolverOption(), 2, &cache), e1(p, ::esf::SolverOption(), 2, &cache);
+
+  ESFEngine reference(p);
+
+  EXPECT_EQ(reference.compute(samples[5]), e0.compute(samples[5]));
+
+  auto solved = cache.stats().inserts;
+
+  EXPECT_LT(0u, solved);
+
+  // The second engine finds all hitting probabilities in the cache.
+  EXPECT_EQ(reference.compute(samples[5]), e1.compute(samples[5]));
+
+  EXPECT_EQ(solved, cache.stats().inserts);
+
+}
+
+
+}
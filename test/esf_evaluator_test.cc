@@ -0,0 +1,145 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_evaluator_test.cc - [unit test] ESFEvaluator
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <memory>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "esf_evaluator.hh"
+#include "esf_graph.hh"
+#include "esf_prob.hh"
+#include "hit_prob.hh"
+#include "hit_prob_store.hh"
+#include "param.hh"
+#include "temp_dir.hh"
+#include "util.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Allele;
+using ::esf::AFS;
+using ::esf::ESFEvaluator;
+using ::esf::ESFGraph;
+using ::esf::ESFProb;
+using ::esf::Param;
+using vector = ::std::vector<Allele>;
+
+
+class ESFEvaluatorTest: public ::testing::Test {
+
+ protected:
+
+  ESFEvaluatorTest()
+      : samples({AFS(vector({Allele({1, 0})})),
+                 AFS(vector({Allele({1, 0}), Allele({0, 1})})),
+                 AFS(vector({Allele({2, 0}), Allele({0, 1})})),
+                 AFS(vector({Allele({2, 1}), Allele({1, 1}), Allele({0, 1})})),
+                 AFS(vector({Allele({3, 2}), Allele({1, 0})}))}),
+        params({Param({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4}),
+                Param({0.0, 0.3, 0.7, 0.0}, {1.0, 0.5}, {0.6, 0.1}),
+                Param({0.0, 2.0, 1.0, 0.0}, {2.0, 1.0}, {1.0, 1.0})}) {}
+
+  ::std::vector<AFS> samples;
+
+  ::std::vector<Param> params;
+
+};
+
+
+TEST_F(ESFEvaluatorTest, SameAsRecursion) {
+
+  for (auto const& afs: samples) {
+
+    ESFEvaluator evaluator(::std::make_shared<ESFGraph>(afs));
+
+    // Parameters after the first reuse hitting probabilities.
+    for (auto const& p: params) {
+
+      double expected = ESFProb(afs, p).compute();
+
+      EXPECT_NEAR(expected, evaluator.compute(p), 1e-12 * (1.0 + expected));
+
+    }
+
+  }
+
+}
+
+
+TEST_F(ESFEvaluatorTest, Repeat) {
+
+  ESFEvaluator evaluator(::std::make_shared<ESFGraph>(samples[4]));
+
+  auto val = evaluator.compute(params[0]);
+
+  evaluator.compute(params[1]);
+
+  EXPECT_DOUBLE_EQ(val, evaluator.compute(params[0]));
+
+}
+
+
+TEST_F(ESFEvaluatorTest, Store) {
+
+  ::esf::test::TempDir dir;
+
+  ::esf::HitProbStore store(dir.path("hit_prob.store"));
+
+  auto const& afs = samples[3];
+
+  auto graph = ::std::make_shared<ESFGraph>(afs);
+
+  ESFEvaluator(graph, ::esf::SolverOption(), &store).compute(params[0]);
+
+  // Found and solved hitting probabilities alternate, and those found
+  // first are updated later.
+  ESFEvaluator evaluator(graph, ::esf::SolverOption(), &store);
+
+  for (auto i: {0, 1, 0, 2, 1}) {
+
+    double expected = ESFProb(afs, params[::esf::unsign(i)]).compute();
+
+    EXPECT_NEAR(expected, evaluator.compute(params[::esf::unsign(i)]), 1e-12 * (1.0 + expected));
+
+  }
+
+}
+
+
+TEST_F(ESFEvaluatorTest, SharedGraph) {
+
+  auto graph = ::std::make_shared<ESFGraph>(samples[3]);
+
+  ESFEvaluator e0(graph), e1(graph, ::esf::SolverOption(::esf::SolverType::DenseLU));
+
+  EXPECT_EQ(&e0.graph(), &e1.graph());
+  EXPECT_NEAR(e0.compute(params[1]), e1.compute(params[1]), 1e-12);
+
+}
+
+
+}
@@ -0,0 +1,331 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_graph_test.cc - [unit test] ESFGraph
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "esf_evaluator.hh"
+#include "esf_graph.hh"
+#include "esf_prob.hh"
+#include "param.hh"
+#include "util.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Allele;
+using ::esf::AFS;
+using ::esf::ESFGraph;
+using ::esf::Index;
+using vector = ::std::vector<Allele>;
+
+
+TEST(ESFGraphTest, SingleGene) {
+
+  ESFGraph graph(AFS(vector({Allele({1, 0})})));
+
+  EXPECT_EQ(1, graph.nodes());
+  EXPECT_EQ(0, graph.root());
+  EXPECT_DOUBLE_EQ(1.0, graph.constants()[0]);
+  EXPECT_TRUE(graph.terms().empty());
+  EXPECT_TRUE(graph.inits().empty());
+
+}
+
+
+TEST(ESFGraphTest, Order) {
+
+  AFS afs(vector({Allele({3, 2}), Allele({1, 0})}));
+
+  ESFGraph graph(afs);
+
+  auto const& first = graph.first();
+  auto const& terms = graph.terms();
+
+  ASSERT_EQ(graph.nodes() + 1, Index(first.size()));
+  EXPECT_EQ(Index(terms.size()), first.back());
+
+  // Children come before their parents.
+  for (Index n = 0; n < graph.nodes(); ++n) {
+
+    for (auto t = first[n]; t < first[n + 1]; ++t) {
+
+      EXPECT_LT(terms[t].child, n);
+      EXPECT_LE(0, terms[t].hit);
+      EXPECT_GT(Index(graph.hits().size()), terms[t].hit);
+
+    }
+
+  }
+
+  // The first slot stands for one, and the others are hitting
+  // probabilities of known initial conditions.
+  EXPECT_EQ(-1, graph.hits()[0].init);
+
+  for (decltype(graph.hits().size()) i = 1; i < graph.hits().size(); ++i) {
+
+    EXPECT_GT(Index(graph.inits().size()), graph.hits()[i].init);
+
+  }
+
+}
+
+
+TEST(ESFGraphTest, Nodes) {
+
+  AFS afs(vector({Allele({2, 1}), Allele({1, 1}), Allele({0, 1})}));
+
+  ESFGraph graph(afs);
+
+  ::esf::Param p({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4});
+
+  ::esf::ESFProb prob(afs, p);
+
+  prob.compute();
+
+  // Terms with zero coefficient are dropped, so the graph may be
+  // smaller than the recursion.
+  EXPECT_GE(Index(prob.esf_prob_cache_stats().size), graph.nodes());
+  EXPECT_LT(1, graph.nodes());
+
+}
+
+
+TEST(ESFGraphTest, SaveAndMap) {
+
+  ::std::string path("esf_graph_test.graph");
+
+  ESFGraph graph(AFS(vector({Allele({3, 2}), Allele({1, 0})})));
+
+  graph.save(path);
+
+  auto mapped = ::std::make_shared<ESFGraph>(ESFGraph::map(path));
+
+  ASSERT_EQ(graph.nodes(), mapped->nodes());
+  ASSERT_EQ(graph.terms().size(), mapped->terms().size());
+  ASSERT_EQ(graph.hits().size(), mapped->hits().size());
+  ASSERT_EQ(graph.inits().size(), mapped->inits().size());
+
+  for (decltype(graph.inits().size()) i = 0; i < graph.inits().size(); ++i) {
+
+    EXPECT_EQ(graph.inits()[i], mapped->inits()[i]);
+
+  }
+
+  for (decltype(graph.terms().size()) t = 0; t < graph.terms().size(); ++t) {
+
+    EXPECT_EQ(graph.terms()[t].child, mapped->terms()[t].child);
+    EXPECT_EQ(graph.terms()[t].hit, mapped->terms()[t].hit);
+    EXPECT_EQ(graph.terms()[t].coef, mapped->terms()[t].coef);
+
+  }
+
+  ::esf::Param p({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4});
+
+  ::esf::ESFEvaluator e0(::std::make_shared<ESFGraph>(graph)), e1(mapped);
+
+  EXPECT_EQ(e0.compute(p), e1.compute(p));
+
+  ::std::remove(path.c_str());
+
+}
+
+
+TEST(ESFGraphTest, MapInvalidFile) {
+
+  ::std::string path("esf_graph_test.invalid");
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  {
+    ::std::ofstream out(path);
+    out << "not a graph, but long enough to hold a header of a graph file";
+  }
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  ESFGraph(AFS(vector({Allele({2, 0}), Allele({0, 1})}))).save(path);
+
+  // Drop the last byte.
+  ::std::string bytes;
+
+  {
+    ::std::ifstream in(path, ::std::ios::binary);
+    bytes.assign(::std::istreambuf_iterator<char>(in), ::std::istreambuf_iterator<char>());
+  }
+
+  {
+    ::std::ofstream out(path, ::std::ios::binary | ::std::ios::trunc);
+    out.write(bytes.data(), static_cast<::std::streamsize>(bytes.size() - 1));
+  }
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  ::std::remove(path.c_str());
+
+}
+
+
+TEST(ESFGraphTest, MapCorruptedIndices) {
+
+  ::std::string path("esf_graph_test.corrupted");
+
+  ESFGraph graph(AFS(vector({Allele({2, 0}), Allele({0, 1})})));
+
+  ASSERT_LT(2, graph.nodes());
+
+  graph.save(path);
+
+  ::std::string bytes;
+
+  {
+    ::std::ifstream in(path, ::std::ios::binary);
+    bytes.assign(::std::istreambuf_iterator<char>(in), ::std::istreambuf_iterator<char>());
+  }
+
+  // Terms are at the end of the file, and offsets of terms precede
+  // them.
+  auto terms = bytes.size() - graph.terms().size() * sizeof(ESFGraph::Term);
+  auto first = terms - ::esf::unsign(graph.nodes() + 1) * sizeof(Index);
+
+  auto corrupt = [&](::std::size_t offset, Index value)
+    {
+      auto copy = bytes;
+
+      ::std::memcpy(&copy[offset], &value, sizeof(value));
+
+      ::std::ofstream out(path, ::std::ios::binary | ::std::ios::trunc);
+      out.write(copy.data(), static_cast<::std::streamsize>(copy.size()));
+    };
+
+  // The root refers to itself.
+  corrupt(bytes.size() - sizeof(ESFGraph::Term), graph.root());
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // A child out of range.
+  corrupt(terms, graph.nodes());
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // A slot of hitting probability out of range.
+  corrupt(terms + sizeof(Index), ::esf::sign(graph.hits().size()));
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // Offsets decrease.
+  corrupt(first + sizeof(Index), ::esf::sign(graph.terms().size()) + 1);
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // Offsets of the first node are intact.
+  corrupt(first, 0);
+
+  EXPECT_NO_THROW(ESFGraph::map(path));
+
+  ::std::remove(path.c_str());
+
+}
+
+
+TEST(ESFGraphTest, MapCorruptedCounts) {
+
+  ::std::string path("esf_graph_test.counts");
+
+  ESFGraph graph(AFS(vector({Allele({2, 0}), Allele({0, 1})})));
+
+  graph.save(path);
+
+  ::std::string bytes;
+
+  {
+    ::std::ifstream in(path, ::std::ios::binary);
+    bytes.assign(::std::istreambuf_iterator<char>(in), ::std::istreambuf_iterator<char>());
+  }
+
+  // The header holds 24 bytes of format, followed by counts of demes,
+  // initial conditions, slots, nodes and terms, and genes follow it.
+  ::std::size_t const counts = 24, genes = 64;
+
+  auto write = [&](::std::vector<::std::pair<::std::size_t, ::std::uint64_t>> values)
+    {
+      auto copy = bytes;
+
+      for (auto const& v: values) {
+
+        ::std::memcpy(&copy[v.first], &v.second, sizeof(v.second));
+
+      }
+
+      ::std::ofstream out(path, ::std::ios::binary | ::std::ios::trunc);
+      out.write(copy.data(), static_cast<::std::streamsize>(copy.size()));
+    };
+
+  write({});
+
+  ASSERT_NO_THROW(ESFGraph::map(path));
+
+  // The size of terms wraps around.
+  write({{counts + 32, (::std::uint64_t(1) << 63) / 3 + 1}});
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // Counts of demes and initial conditions whose product wraps around.
+  write({{counts, ::std::uint64_t(1) << 62}, {counts + 8, 4}});
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // Counts of genes, whose number of states does not fit.
+  write({{genes, ::std::uint64_t(1) << 40},
+         {genes + sizeof(Index), ::std::uint64_t(1) << 40}});
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // A negative count of genes.
+  write({{genes, ::std::uint64_t(-1)}});
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  // A graph without nodes has no root.
+  ESFGraph().save(path);
+
+  EXPECT_THROW(ESFGraph::map(path), ::std::runtime_error);
+
+  ::std::remove(path.c_str());
+
+}
+
+
+}
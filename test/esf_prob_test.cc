@@ -104,4 +104,41 @@ TEST_F(ESFProbTest, WithoutSingleton) {
 }
 
 
+TEST_F(ESFProbTest, IterativeSolver) {
+
+  ::esf::SolverOption option(::esf::SolverType::GMRES, 1.0e-14);
+
+  ESFProb p0(ns3, p, option);
+  EXPECT_NEAR(0.6290216399468798, p0.compute(), 1e-6);
+
+  ESFProb p1(s33, p, option);
+  EXPECT_NEAR(0.3068718689857209, p1.compute(), 1e-6);
+
+}
+
+
+TEST_F(ESFProbTest, CacheStats) {
+
+  ESFProb p0(s33, p);
+
+  auto val = p0.compute();
+
+  auto esf = p0.esf_prob_cache_stats();
+  auto hit = p0.hit_prob_cache_stats();
+
+  EXPECT_EQ(esf.misses, esf.inserts);
+  EXPECT_EQ(esf.inserts, esf.size);
+  EXPECT_LT(0u, esf.hits);
+  EXPECT_LT(0.0, esf.load_factor);
+
+  EXPECT_EQ(hit.inserts, hit.size);
+  EXPECT_LT(0u, hit.size);
+
+  // Another evaluation is answered by the cache.
+  EXPECT_DOUBLE_EQ(val, p0.compute());
+  EXPECT_EQ(esf.hits + 1, p0.esf_prob_cache_stats().hits);
+
+}
+
+
 }
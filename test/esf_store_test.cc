@@ -0,0 +1,234 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// esf_store_test.cc - [unit test] ESFStore
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "esf_prob.hh"
+#include "esf_store.hh"
+#include "param.hh"
+#include "temp_dir.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::AFS;
+using ::esf::Allele;
+using ::esf::ESFProb;
+using ::esf::ESFStore;
+using ::esf::Param;
+using vector = ::std::vector<Allele>;
+
+
+class ESFStoreTest: public ::testing::Test {
+
+ protected:
+
+  ESFStoreTest()
+      : dir(), path(dir.path("esf.store")),
+        a0(vector({Allele({2, 0}), Allele({0, 1})})),
+        a1(vector({Allele({2, 1}), Allele({1, 1}), Allele({0, 1})})),
+        p({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4}) {}
+
+  ::esf::test::TempDir dir;
+
+  ::std::string path;
+
+  AFS a0, a1;
+
+  Param p;
+
+  ::esf::SolverOption o;
+
+};
+
+
+TEST_F(ESFStoreTest, InsertAndFind) {
+
+  ESFStore store(path);
+
+  double val = 0.0;
+
+  EXPECT_FALSE(store.find(1, o, a0, val));
+
+  store.insert(1, o, a0, 0.25);
+  store.insert(2, o, a0, 0.5);
+  store.insert(1, o, a0, 0.75);
+
+  EXPECT_EQ(2u, store.size());
+
+  ASSERT_TRUE(store.find(1, o, a0, val));
+  EXPECT_EQ(0.25, val);
+
+  ASSERT_TRUE(store.find(2, o, a0, val));
+  EXPECT_EQ(0.5, val);
+
+  EXPECT_FALSE(store.find(1, o, a1, val));
+
+}
+
+
+TEST_F(ESFStoreTest, SolverOption) {
+
+  using ::esf::SolverOption;
+  using ::esf::SolverType;
+
+  ESFStore store(path);
+
+  store.insert(1, o, a0, 0.25);
+
+  double val = 0.0;
+
+  // Probabilities computed with other solvers or tolerances differ.
+  EXPECT_FALSE(store.find(1, SolverOption(SolverType::MatrixFree, o.tolerance), a0, val));
+  EXPECT_FALSE(store.find(1, SolverOption(o.type, 1.0e-6), a0, val));
+
+  // Other options do not take part in the key.
+  ASSERT_TRUE(store.find(1, SolverOption(o.type, o.tolerance, 10, 4), a0, val));
+  EXPECT_EQ(0.25, val);
+
+}
+
+
+TEST_F(ESFStoreTest, Reopen) {
+
+  {
+    ESFStore store(path, 1);
+
+    store.insert(1, o, a0, 0.25);
+    store.insert(1, o, a1, 0.125);
+  }
+
+  ESFStore store(path);
+
+  EXPECT_EQ(2u, store.size());
+
+  double val = 0.0;
+
+  ASSERT_TRUE(store.find(1, o, a1, val));
+  EXPECT_EQ(0.125, val);
+
+  // Records are appended to those already stored.
+  store.insert(2, o, a1, 0.0625);
+  store.flush();
+
+  ESFStore again(path);
+
+  EXPECT_EQ(3u, again.size());
+  ASSERT_TRUE(again.find(2, o, a1, val));
+  EXPECT_EQ(0.0625, val);
+
+}
+
+
+TEST_F(ESFStoreTest, WithoutIndex) {
+
+  {
+    ESFStore store(path);
+
+    store.insert(1, o, a0, 0.25);
+  }
+
+  ::std::remove((path + ".idx").c_str());
+
+  // A record partially written is dropped.
+  {
+    ::std::ofstream out(path, ::std::ios::binary | ::std::ios::app);
+    out << "partial";
+  }
+
+  ESFStore store(path);
+
+  EXPECT_EQ(1u, store.size());
+
+  double val = 0.0;
+
+  ASSERT_TRUE(store.find(1, o, a0, val));
+  EXPECT_EQ(0.25, val);
+
+  store.insert(1, o, a1, 0.5);
+  store.flush();
+
+  EXPECT_EQ(2u, ESFStore(path).size());
+
+}
+
+
+TEST_F(ESFStoreTest, InvalidFile) {
+
+  {
+    ::std::ofstream out(path);
+    out << "not a store";
+  }
+
+  EXPECT_THROW(ESFStore store(path), ::std::runtime_error);
+
+}
+
+
+TEST_F(ESFStoreTest, ESFProb) {
+
+  double cold;
+
+  {
+    ESFStore store(path);
+
+    ESFProb prob(a1, p, ::esf::SolverOption(), &store);
+
+    cold = prob.compute();
+
+    EXPECT_EQ(prob.esf_prob_cache_stats().size, store.size());
+  }
+
+  ESFStore store(path);
+
+  auto stored = store.size();
+
+  ESFProb prob(a1, p, ::esf::SolverOption(), &store);
+
+  // The sample is found in the store without recursion.
+  EXPECT_EQ(cold, prob.compute());
+  EXPECT_EQ(1u, prob.esf_prob_cache_stats().size);
+  EXPECT_EQ(0u, prob.hit_prob_cache_stats().size);
+  EXPECT_EQ(stored, store.size());
+
+  // Other parameters are computed.
+  Param q({0.0, 0.5, 0.5, 0.0}, {1.0, 1.0}, {0.3, 0.3});
+
+  ESFProb other(a1, q, ::esf::SolverOption(), &store);
+
+  EXPECT_EQ(ESFProb(a1, q).compute(), other.compute());
+  EXPECT_LT(stored, store.size());
+
+}
+
+
+}
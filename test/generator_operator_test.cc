@@ -0,0 +1,152 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// generator_operator_test.cc - [unit test] generator_operator
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "generator.hh"
+#include "generator_operator.hh"
+#include "init.hh"
+#include "param.hh"
+#include "thread_pool.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::GeneratorOperator;
+using ::esf::Index;
+using vector_type = GeneratorOperator::vector_type;
+
+
+class GeneratorOperatorTest: public ::testing::Test {
+
+ protected:
+
+  GeneratorOperatorTest()
+      : init3({1, 2, 1}),
+        init4({2, 1, 0, 3}),
+        param3({0.0, 1.0, 0.5, 1.5, 0.0, 2.0, 2.5, 3.0, 0.0},
+               {1.0, 1.5, 2.0}, {0.2, 0.4, 0.6}),
+        param4({0.0, 1.0, 0.5, 0.0, 1.5, 0.0, 2.0, 0.3, 2.5, 3.0, 0.0, 0.7,
+                0.1, 0.2, 0.4, 0.0},
+               {1.0, 1.5, 2.0, 0.5}, {0.2, 0.4, 0.6, 0.8}),
+        serial(1), parallel(4) {}
+
+  ::esf::Init init3, init4;
+  ::esf::Param param3, param4;
+  ::esf::ThreadPool serial, parallel;
+
+  void compare(::esf::Init const& init, ::esf::Param const& param,
+               ::esf::ThreadPool& pool) {
+
+    std::vector<double> coals;
+
+    auto u = ::esf::assemble_generator(init, param, coals);
+
+    GeneratorOperator op(init, param, pool);
+
+    ASSERT_EQ(init.dim(), op.dim());
+
+    vector_type x = vector_type::LinSpaced(op.dim(), -1.0, 2.0), y;
+
+    op.apply(x, y);
+
+    vector_type exp = u * x;
+
+    for (auto i = 0; i < op.dim(); ++i) {
+
+      EXPECT_NEAR(u.coeff(i, i), op.diagonal()(i), 1.0e-12);
+      EXPECT_NEAR(exp(i), y(i), 1.0e-12);
+
+      for (auto j = 0; j < init.deme(); ++j) {
+
+        EXPECT_DOUBLE_EQ(coals[::esf::unsign(i * init.deme() + j)], op.coal(i, j));
+
+      }
+
+    }
+
+  }
+
+};
+
+
+TEST_F(GeneratorOperatorTest, ThreeDeme) {
+
+  compare(init3, param3, serial);
+  compare(init3, param3, parallel);
+
+}
+
+
+TEST_F(GeneratorOperatorTest, FourDeme) {
+
+  compare(init4, param4, serial);
+  compare(init4, param4, parallel);
+
+}
+
+
+TEST_F(GeneratorOperatorTest, ParallelIsDeterministic) {
+
+  ::esf::Init init({3, 2, 3, 2});
+
+  GeneratorOperator op1(init, param4, serial), op4(init, param4, parallel);
+
+  vector_type x = vector_type::LinSpaced(op1.dim(), 0.0, 1.0), y1, y4;
+
+  op1.apply(x, y1);
+  op4.apply(x, y4);
+
+  EXPECT_EQ(y1, y4);
+
+}
+
+
+TEST_F(GeneratorOperatorTest, Solve) {
+
+  std::vector<double> coals;
+
+  auto u = ::esf::assemble_generator(init4, param4, coals);
+
+  GeneratorOperator op(init4, param4, parallel);
+
+  vector_type b = vector_type::Zero(op.dim()), x;
+  b(0) = 1.0;
+
+  Index iterations;
+  double error;
+
+  EXPECT_TRUE(::esf::solve(op, b, x, 1.0e-12, 0, iterations, error));
+  EXPECT_LT(0, iterations);
+  EXPECT_GE(1.0e-12, error);
+
+  vector_type r = u * x - b;
+
+  EXPECT_GE(1.0e-10, r.norm());
+
+}
+
+
+}
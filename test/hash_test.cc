@@ -0,0 +1,129 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hash_test.cc - [unit test] hash
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "hash.hh"
+#include "init.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::AFS;
+using ::esf::Allele;
+using ::esf::Init;
+using ::std::vector;
+
+
+TEST(HashTest, Mix) {
+
+  EXPECT_NE(::esf::hash_mix(0), ::esf::hash_mix(1));
+  EXPECT_NE(::esf::hash_combine(0, 1), ::esf::hash_combine(1, 0));
+  EXPECT_NE(::esf::hash_combine(::esf::hash_combine(0, 1), 2),
+            ::esf::hash_combine(::esf::hash_combine(0, 2), 1));
+
+}
+
+
+TEST(HashTest, Init) {
+
+  ::std::hash<Init> hasher;
+
+  // Counts of 16 genes do not overflow into the next deme.
+  EXPECT_NE(hasher(Init(vector<::esf::Index>({16, 0}))), hasher(Init(vector<::esf::Index>({0, 1}))));
+  EXPECT_NE(hasher(Init(vector<::esf::Index>({1, 2}))), hasher(Init(vector<::esf::Index>({2, 1}))));
+  EXPECT_EQ(hasher(Init(vector<::esf::Index>({1, 2}))), hasher(Init(vector<::esf::Index>({1, 2}))));
+
+}
+
+
+TEST(HashTest, AFS) {
+
+  ::std::hash<AFS> hasher;
+
+  AFS a0(vector<Allele>({Allele({1, 0}), Allele({0, 1})}));
+  AFS a1(vector<Allele>({Allele({0, 1}), Allele({1, 0})}));
+  AFS a2(vector<Allele>({Allele({1, 0}), Allele({1, 0})}));
+  AFS a3(vector<Allele>({Allele({1, 1})}));
+
+  EXPECT_EQ(hasher(a0), hasher(a1));
+  EXPECT_NE(hasher(a0), hasher(a2));
+  EXPECT_NE(hasher(a0), hasher(a3));
+  EXPECT_NE(hasher(a2), hasher(a3));
+
+}
+
+
+TEST(HashTest, Diagnose) {
+
+  ::std::unordered_map<int, int> table;
+
+  for (int i = 0; i < 100; ++i) {
+
+    table[i] = i;
+
+  }
+
+  auto diag = ::esf::diagnose(table);
+
+  EXPECT_EQ(100u, diag.keys);
+  EXPECT_EQ(table.bucket_count(), diag.buckets);
+
+  ::std::size_t buckets = 0, keys = 0;
+
+  for (::std::size_t i = 0; i < diag.bucket_lengths.size(); ++i) {
+
+    buckets += diag.bucket_lengths[i];
+    keys += i * diag.bucket_lengths[i];
+
+  }
+
+  EXPECT_EQ(diag.buckets, buckets);
+  EXPECT_EQ(diag.keys, keys);
+
+  EXPECT_LE(0.0, diag.bucket_collision_rate);
+  EXPECT_GE(1.0, diag.bucket_collision_rate);
+  EXPECT_DOUBLE_EQ(0.0, diag.hash_collision_rate);
+  EXPECT_LE(1.0, diag.mean_probe);
+
+}
+
+
+TEST(HashTest, DiagnoseEmpty) {
+
+  auto diag = ::esf::diagnose(::std::unordered_map<int, int>());
+
+  EXPECT_EQ(0u, diag.keys);
+  EXPECT_DOUBLE_EQ(0.0, diag.bucket_collision_rate);
+  EXPECT_DOUBLE_EQ(0.0, diag.mean_probe);
+
+}
+
+
+}
@@ -0,0 +1,183 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hit_prob_store_test.cc - [unit test] HitProbStore
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "esf_evaluator.hh"
+#include "esf_graph.hh"
+#include "esf_prob.hh"
+#include "hit_prob.hh"
+#include "hit_prob_store.hh"
+#include "init.hh"
+#include "param.hh"
+#include "temp_dir.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::HitProb;
+using ::esf::HitProbStore;
+using ::esf::Init;
+using ::esf::Param;
+using ::esf::SolverOption;
+
+
+class HitProbStoreTest: public ::testing::Test {
+
+ protected:
+
+  HitProbStoreTest()
+      : dir(), path(dir.path("hit_prob.store")),
+        init(::std::vector<::esf::Index>({2, 3})),
+        p({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4}),
+        q({0.0, 0.5, 0.5, 0.0}, {1.0, 1.0}, {0.3, 0.3}) {}
+
+  ::esf::test::TempDir dir;
+
+  ::std::string path;
+
+  Init init;
+
+  Param p, q;
+
+};
+
+
+TEST_F(HitProbStoreTest, InsertAndFind) {
+
+  HitProb solved(init, p);
+
+  {
+    HitProbStore store(path);
+
+    HitProb found;
+
+    EXPECT_FALSE(store.find(init, p, SolverOption(), found));
+
+    store.insert(solved);
+
+    EXPECT_EQ(1u, store.size());
+    EXPECT_TRUE(store.find(init, p, SolverOption(), found));
+    EXPECT_FALSE(store.find(init, q, SolverOption(), found));
+  }
+
+  HitProbStore store(path);
+
+  HitProb found;
+
+  ASSERT_TRUE(store.find(init, p, SolverOption(), found));
+
+  EXPECT_EQ(solved.values(), found.values());
+  EXPECT_EQ(init, found.init());
+
+}
+
+
+TEST_F(HitProbStoreTest, SolverOption) {
+
+  using ::esf::SolverType;
+
+  HitProbStore store(path);
+
+  SolverOption loose(SolverType::BiCGSTAB, 1.0e-4);
+
+  auto h0 = store.get_or_compute(init, p, loose);
+
+  HitProb found;
+
+  // Probabilities solved by other solvers or tolerances differ.
+  EXPECT_FALSE(store.find(init, p, SolverOption(), found));
+  EXPECT_FALSE(store.find(init, p, SolverOption(SolverType::BiCGSTAB), found));
+
+  auto h1 = store.get_or_compute(init, p, SolverOption());
+
+  EXPECT_EQ(2u, store.size());
+  EXPECT_EQ(HitProb(init, p).values(), h1.values());
+
+  ASSERT_TRUE(store.find(init, p, loose, found));
+  EXPECT_EQ(h0.values(), found.values());
+
+}
+
+
+TEST_F(HitProbStoreTest, GetOrCompute) {
+
+  HitProbStore store(path);
+
+  auto h0 = store.get_or_compute(init, p);
+  auto h1 = store.get_or_compute(init, p);
+  auto h2 = store.get_or_compute(init, q);
+
+  EXPECT_EQ(2u, store.size());
+  EXPECT_EQ(h0.values(), h1.values());
+  EXPECT_EQ(HitProb(init, q).values(), h2.values());
+
+}
+
+
+TEST_F(HitProbStoreTest, ESFProb) {
+
+  ::esf::AFS afs(::std::vector<::esf::Allele>(
+      {::esf::Allele({2, 1}), ::esf::Allele({1, 1}), ::esf::Allele({0, 1})}));
+
+  auto expected = ::esf::ESFProb(afs, p).compute();
+
+  {
+    HitProbStore store(path);
+
+    ::esf::ESFProb prob(afs, p, SolverOption(), nullptr, &store);
+
+    EXPECT_EQ(expected, prob.compute());
+    EXPECT_EQ(prob.hit_prob_cache_stats().size, store.size());
+  }
+
+  HitProbStore store(path);
+
+  auto stored = store.size();
+
+  ::esf::ESFProb prob(afs, p, SolverOption(), nullptr, &store);
+
+  EXPECT_EQ(expected, prob.compute());
+  EXPECT_EQ(stored, store.size());
+
+  // The compiled recursion finds the same initial conditions.
+  ::esf::ESFEvaluator evaluator(::std::make_shared<::esf::ESFGraph>(afs),
+                                SolverOption(), &store);
+
+  EXPECT_NEAR(expected, evaluator.compute(p), 1e-12);
+  EXPECT_EQ(stored, store.size());
+
+  evaluator.compute(q);
+
+  EXPECT_LT(stored, store.size());
+
+}
+
+
+}
@@ -0,0 +1,169 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// hit_prob_structure_test.cc - [unit test] hit_prob_structure
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <vector>
+
+#include "hit_prob_structure.hh"
+#include "init.hh"
+#include "param.hh"
+#include "state.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Index;
+
+
+class HitProbStructureTest: public ::testing::Test {
+
+ protected:
+
+  HitProbStructureTest()
+      : init2({2, 3}),
+        param2({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4}),
+        s2(init2) {}
+
+  ::esf::Init init2;
+  ::esf::Param param2;
+  ::esf::HitProbStructure s2;
+
+};
+
+
+TEST_F(HitProbStructureTest, Start) {
+
+  EXPECT_EQ(::esf::State(init2).id(), s2.start());
+
+}
+
+
+TEST_F(HitProbStructureTest, Coal) {
+
+  for (auto i = 0; i < init2.dim(); ++i) {
+
+    ::esf::State s(init2, i);
+
+    ::esf::Init ii(s);
+
+    for (auto j = 0; j < init2.deme(); ++j) {
+
+      EXPECT_DOUBLE_EQ(ii[j] * (ii[j] - 1) / 2, s2.coal(i, j));
+
+    }
+
+  }
+
+}
+
+
+TEST_F(HitProbStructureTest, ColumnSum) {
+
+  auto const& u = s2.fill(param2);
+
+  EXPECT_EQ(init2.dim(), u.rows());
+  EXPECT_EQ(init2.dim(), u.cols());
+
+  // Off-diagonal elements are rates of migration, and the remainder
+  // of each column is the rate of coalescence and mutation.
+  for (auto i = 0; i < init2.dim(); ++i) {
+
+    ::esf::State s(init2, i);
+
+    ::esf::Init ii(s);
+
+    double sum = 0.0, exit = 0.0;
+
+    for (::esf::Generator::InnerIterator it(u, i); it; ++it) {
+
+      sum += it.value();
+
+      if (it.row() != i) {
+
+        EXPECT_LT(0.0, it.value());
+
+      }
+
+    }
+
+    for (auto j = 0; j < init2.deme(); ++j) {
+
+      exit += ii[j] * (ii[j] - 1) * param2.pop_size(j) + ii[j] * param2.mut_rate(j);
+
+    }
+
+    EXPECT_NEAR(-exit, sum, 1.0e-12);
+
+  }
+
+}
+
+
+TEST_F(HitProbStructureTest, Storage) {
+
+  auto const& u = s2.fill(param2);
+
+  // The storage is allocated for the exact number of non-zero elements.
+  EXPECT_EQ(u.nonZeros(), u.data().allocatedSize());
+
+}
+
+
+TEST_F(HitProbStructureTest, Neighbors) {
+
+  auto const& u = s2.fill(param2);
+
+  for (auto i = 0; i < init2.dim(); ++i) {
+
+    ::esf::State s(init2, i);
+
+    ::std::vector<Index> exp, test;
+
+    for (auto adj: s.neighbors()) {
+
+      exp.push_back(adj.id());
+
+    }
+
+    for (::esf::Generator::InnerIterator it(u, i); it; ++it) {
+
+      if (it.row() != i) {
+
+        test.push_back(it.row());
+
+      }
+
+    }
+
+    ::std::sort(exp.begin(), exp.end());
+
+    EXPECT_EQ(exp, test);
+
+  }
+
+}
+
+
+}
@@ -23,6 +23,7 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 // DEALINGS IN THE SOFTWARE.
 
+#include <stdexcept>
 #include <vector>
 using ::std::vector;
 
@@ -127,4 +128,217 @@ TEST_F(HitProbTest, ThreeDeme) {
 }
 
 
+TEST_F(HitProbTest, UpdateParameters) {
+
+  using ::esf::SolverOption;
+  using ::esf::SolverType;
+
+  ::esf::Param p2({0.0, 0.3, 2.0, 0.0}, {0.5, 2.0}, {0.1, 0.7});
+
+  // Small systems are solved by DenseLU by default, and the threshold
+  // of zero takes the sparse path through the shared structure.
+  for (auto const& option: {SolverOption(),
+                            SolverOption(SolverType::SparseLU, 1.0e-12, 0, 0, 0)}) {
+
+    ::esf::HitProb base(init2, param2, option);
+
+    auto updated = base.update(p2);
+    ::esf::HitProb fresh(init2, p2);
+
+    EXPECT_EQ(base.solver(), updated.solver());
+
+    for (auto i = 0; i < init2.dim(); ++i) {
+
+      for (auto j = 0; j < init2.deme(); ++j) {
+
+        EXPECT_NEAR(fresh.get(i, j), updated.get(i, j), 1.0e-12);
+
+      }
+
+    }
+
+    // Going back to the original parameters reproduces original values.
+    auto back = updated.update(param2);
+
+    for (auto i = 0; i < init2.dim(); ++i) {
+
+      for (auto j = 0; j < init2.deme(); ++j) {
+
+        EXPECT_NEAR(hp2.get(i, j), back.get(i, j), 1.0e-12);
+
+      }
+
+    }
+
+  }
+
+  EXPECT_EQ(SolverType::SparseLU,
+            ::esf::HitProb(init2, param2,
+                           SolverOption(SolverType::SparseLU, 1.0e-12, 0, 0, 0)).solver());
+
+}
+
+
+TEST_F(HitProbTest, UpdateValues) {
+
+  ::esf::Param p2({0.0, 0.3, 2.0, 0.0}, {0.5, 2.0}, {0.1, 0.7});
+
+  ::esf::HitProb fresh(init2, p2);
+
+  // Probabilities solved elsewhere are taken as they are.
+  auto loaded = hp2.update(p2, fresh.values());
+
+  EXPECT_EQ(fresh.values(), loaded.values());
+
+  auto back = loaded.update(param2);
+
+  for (auto i = 0; i < init2.dim(); ++i) {
+
+    for (auto j = 0; j < init2.deme(); ++j) {
+
+      EXPECT_NEAR(hp2.get(i, j), back.get(i, j), 1.0e-12);
+
+    }
+
+  }
+
+  EXPECT_THROW(hp2.update(p2, ::std::vector<double>(1)), ::std::invalid_argument);
+
+}
+
+
+TEST_F(HitProbTest, IterativeSolvers) {
+
+  using ::esf::SolverOption;
+  using ::esf::SolverType;
+
+  for (auto type: {SolverType::BiCGSTAB, SolverType::GMRES, SolverType::MatrixFree}) {
+
+    ::esf::HitProb hp(init3, param3, SolverOption(type, 1.0e-14));
+
+    EXPECT_EQ(type, hp.solver());
+    EXPECT_LT(0, hp.iterations());
+
+    for (auto i = 0; i < init3.dim(); ++i) {
+
+      for (auto j = 0; j < init3.deme(); ++j) {
+
+        EXPECT_NEAR(hp3.get(i, j), hp.get(i, j), 1.0e-10);
+
+      }
+
+    }
+
+  }
+
+}
+
+
+TEST_F(HitProbTest, MatrixFreeUpdate) {
+
+  using ::esf::SolverOption;
+  using ::esf::SolverType;
+
+  ::esf::Param p3({0.0, 0.3, 2.0, 1.0, 0.0, 0.4, 0.2, 0.6, 0.0},
+                  {0.5, 2.0, 1.0}, {0.1, 0.7, 0.3});
+
+  SolverOption option(SolverType::MatrixFree, 1.0e-14, 0, 2);
+
+  // Updated objects solve on the threads of the first one.
+  ::esf::HitProb hp(init3, p3, option);
+
+  auto updated = hp.update(param3).update(p3);
+
+  EXPECT_EQ(SolverType::MatrixFree, updated.solver());
+
+  for (auto i = 0; i < init3.dim(); ++i) {
+
+    for (auto j = 0; j < init3.deme(); ++j) {
+
+      EXPECT_NEAR(hp.get(i, j), updated.get(i, j), 1.0e-10);
+
+    }
+
+  }
+
+}
+
+
+TEST_F(HitProbTest, IterativeSolverFallback) {
+
+  using ::esf::SolverOption;
+  using ::esf::SolverType;
+
+  // One iteration is not enough to reach the tolerance.
+  ::esf::HitProb hp(init3, param3, SolverOption(SolverType::BiCGSTAB, 1.0e-30, 1, 0, 0));
+
+  EXPECT_EQ(SolverType::SparseLU, hp.solver());
+
+  for (auto i = 0; i < init3.dim(); ++i) {
+
+    for (auto j = 0; j < init3.deme(); ++j) {
+
+      EXPECT_NEAR(hp3.get(i, j), hp.get(i, j), 1.0e-12);
+
+    }
+
+  }
+
+}
+
+
+TEST_F(HitProbTest, DenseSolver) {
+
+  using ::esf::SolverOption;
+  using ::esf::SolverType;
+
+  // Small systems use the dense solver by default.
+  EXPECT_EQ(SolverType::DenseLU, hp3.solver());
+
+  ::esf::HitProb sparse(init3, param3, SolverOption(SolverType::SparseLU, 0.0, 0, 0, 0));
+  ::esf::HitProb dense(init3, param3, SolverOption(SolverType::DenseLU, 0.0, 0, 0, 0));
+
+  EXPECT_EQ(SolverType::SparseLU, sparse.solver());
+  EXPECT_EQ(SolverType::DenseLU, dense.solver());
+
+  for (auto i = 0; i < init3.dim(); ++i) {
+
+    for (auto j = 0; j < init3.deme(); ++j) {
+
+      EXPECT_NEAR(sparse.get(i, j), dense.get(i, j), 1.0e-12);
+
+    }
+
+  }
+
+}
+
+
+TEST_F(HitProbTest, FromValues) {
+
+  ::esf::HitProb copy(init3, param3, ::esf::SolverOption(), hp3.values());
+
+  EXPECT_EQ(init3, copy.init());
+
+  for (::esf::Index i = 0; i < init3.dim(); ++i) {
+
+    for (::esf::Index j = 0; j < init3.deme(); ++j) {
+
+      EXPECT_EQ(hp3.get(i, j), copy.get(i, j));
+
+    }
+
+  }
+
+  // Probabilities without the structure are solved again on update.
+  auto updated = copy.update(param3);
+
+  EXPECT_NEAR(hp3.get(1, 1), updated.get(1, 1), 1e-12);
+
+  EXPECT_THROW(::esf::HitProb(init2, param2, ::esf::SolverOption(), hp3.values()),
+               ::std::invalid_argument);
+
+}
+
+
 }
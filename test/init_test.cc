@@ -23,6 +23,8 @@
 // FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
 // DEALINGS IN THE SOFTWARE.
 
+#include <stdexcept>
+
 #include "afs.hh"
 #include "allele.hh"
 #include "init.hh"
@@ -68,6 +70,19 @@ TEST_F(InitTest, TwoDemeTotalDim) {
 }
 
 
+TEST_F(InitTest, TotalDimOverflow) {
+
+  // Each deme has 1003 choose 3 compositions, and their product does
+  // not fit in Index.
+  ::esf::Init init({1000, 1000, 1000, 1000});
+
+  EXPECT_EQ(167668501, init.dim(0));
+
+  EXPECT_THROW(init.dim(), ::std::overflow_error);
+
+}
+
+
 TEST_F(InitTest, TwoDemeNumber) {
 
   EXPECT_EQ(2, i2.deme());
@@ -0,0 +1,178 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// inline_vector_test.cc - [unit test] inline_vector
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "allele.hh"
+#include "init.hh"
+#include "inline_vector.hh"
+#include "state.hh"
+#include "typedef.hh"
+#include "util.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Index;
+
+typedef ::esf::InlineVector<Index, 4> Vec;
+
+
+class InlineVectorTest: public ::testing::Test {
+
+ protected:
+
+  InlineVectorTest() {}
+
+};
+
+
+TEST_F(InlineVectorTest, Construct) {
+
+  Vec a, b(3, 2), c({1, 2, 3}), d(::std::vector<Index>({1, 2, 3}));
+
+  EXPECT_TRUE(a.empty());
+
+  EXPECT_EQ(3u, b.size());
+  EXPECT_EQ(2, b[2]);
+
+  EXPECT_EQ(c, d);
+  EXPECT_NE(b, c);
+
+}
+
+
+TEST_F(InlineVectorTest, Modify) {
+
+  Vec a(2);
+
+  a.push_back(5);
+  a[0] = 1;
+
+  EXPECT_EQ(Vec({1, 0, 5}), a);
+
+  a.resize(1);
+  a.resize(2, 7);
+
+  EXPECT_EQ(Vec({1, 7}), a);
+
+  a.clear();
+
+  EXPECT_EQ(a.begin(), a.end());
+
+}
+
+
+TEST_F(InlineVectorTest, Order) {
+
+  EXPECT_TRUE(Vec({1, 2}) < Vec({1, 3}));
+  EXPECT_TRUE(Vec({1, 2}) < Vec({1, 2, 0}));
+  EXPECT_FALSE(Vec({2}) < Vec({1, 2}));
+
+}
+
+
+TEST_F(InlineVectorTest, Heap) {
+
+  Vec a(4, 1);
+
+  auto inline_data = a.data();
+
+  a.push_back(2);
+  a.push_back(3);
+
+  EXPECT_EQ(6u, a.size());
+  EXPECT_NE(inline_data, a.data());
+  EXPECT_EQ(Vec({1, 1, 1, 1, 2, 3}), a);
+
+  Vec b(a);
+
+  b[5] = 4;
+
+  EXPECT_EQ(3, a[5]);
+  EXPECT_TRUE(a < b);
+
+  a.resize(3);
+
+  EXPECT_EQ(Vec({1, 1, 1}), a);
+
+  // A short copy fits inline.
+  Vec c(a);
+
+  EXPECT_EQ(a, c);
+
+  c = b;
+
+  EXPECT_EQ(b, c);
+
+  b = Vec({2});
+
+  EXPECT_EQ(Vec({2}), b);
+
+  a.resize(8, 5);
+
+  EXPECT_EQ(Vec({1, 1, 1, 5, 5, 5, 5, 5}), a);
+  EXPECT_EQ(Vec({1, 2, 3, 4, 5}), Vec(::std::vector<Index>({1, 2, 3, 4, 5})));
+
+}
+
+
+TEST_F(InlineVectorTest, ManyDemes) {
+
+  using ::esf::Allele;
+  using ::esf::Init;
+  using ::esf::State;
+
+  auto demes = ESF_INLINE_DEME + 1;
+
+  ::std::vector<Index> counts(demes, 0);
+
+  counts[0] = 2;
+  counts[demes - 1] = 1;
+
+  Allele allele(counts);
+
+  EXPECT_EQ(demes, allele.deme());
+  EXPECT_EQ(3, allele.size());
+  EXPECT_EQ(1, allele.remove(0)[0]);
+  EXPECT_EQ(2, allele.add(demes - 1)[demes - 1]);
+
+  Init init(counts);
+
+  for (Index i = 0; i < init.dim(); ++i) {
+
+    State s(init, i);
+
+    ::std::vector<Index> v(s.begin(), s.end());
+
+    EXPECT_EQ(::esf::unsign(demes * demes), v.size());
+    EXPECT_EQ(i, State(init, v).id());
+
+  }
+
+}
+
+
+}
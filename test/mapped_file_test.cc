@@ -0,0 +1,73 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// mapped_file_test.cc - [unit test] mapped_file
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+#include "mapped_file.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::MappedFile;
+
+
+TEST(MappedFileTest, Map) {
+
+  ::std::string path("mapped_file_test.txt");
+
+  {
+    ::std::ofstream out(path);
+    out << "mapped";
+  }
+
+  {
+    MappedFile file(path);
+
+    ASSERT_EQ(6u, file.size());
+    EXPECT_EQ("mapped", ::std::string(file.data(), file.size()));
+  }
+
+  {
+    ::std::ofstream out(path, ::std::ios::trunc);
+  }
+
+  {
+    MappedFile file(path);
+
+    EXPECT_EQ(0u, file.size());
+    EXPECT_EQ(nullptr, file.data());
+  }
+
+  ::std::remove(path.c_str());
+
+  EXPECT_THROW(MappedFile file(path), ::std::runtime_error);
+
+}
+
+
+}
@@ -0,0 +1,235 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// neighbor_table_test.cc - [unit test] neighbor_table
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <algorithm>
+#include <vector>
+
+#include "init.hh"
+#include "neighbor_table.hh"
+#include "param.hh"
+#include "state.hh"
+#include "state_space.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Index;
+using ::esf::Init;
+using ::esf::Move;
+using ::esf::NeighborTable;
+using ::esf::State;
+using ::esf::StateSpace;
+using ::esf::unsign;
+
+
+class NeighborTableTest: public ::testing::Test {
+
+ protected:
+
+  NeighborTableTest()
+      : i2({2, 3}), i3({1, 2, 1}) {}
+
+  Init i2, i3;
+
+};
+
+
+TEST_F(NeighborTableTest, Composition) {
+
+  for (auto const& init: {i2, i3}) {
+
+    NeighborTable table {StateSpace(init)};
+
+    ::std::vector<Index> ranks(unsign(init.deme()));
+
+    for (auto i = 0; i < init.dim(); ++i) {
+
+      State s(init, i);
+
+      table.ranks(i, ranks.data());
+
+      for (auto b = 0; b < init.deme(); ++b) {
+
+        auto comp = table.composition(b, ranks[unsign(b)]);
+
+        for (auto d = 0; d < init.deme(); ++d) {
+
+          EXPECT_EQ(s[b * init.deme() + d], comp[d]);
+
+        }
+
+      }
+
+    }
+
+  }
+
+}
+
+
+TEST_F(NeighborTableTest, Neighbors) {
+
+  for (auto const& init: {i2, i3}) {
+
+    NeighborTable table {StateSpace(init)};
+
+    ::std::vector<Index> ranks(unsign(init.deme()));
+
+    for (auto i = 0; i < init.dim(); ++i) {
+
+      State s(init, i);
+
+      ::std::vector<Index> expected;
+
+      for (auto const& n: s.neighbors()) {
+
+        expected.push_back(n.id());
+
+      }
+
+      ::std::vector<Index> actual;
+
+      table.ranks(i, ranks.data());
+
+      table.for_each(i, ranks.data(), [&](Move const& move) {
+
+          State n(init, move.id);
+
+          EXPECT_EQ(s[move.src], move.genes);
+          EXPECT_EQ(s[move.src] - 1, n[move.src]);
+          EXPECT_EQ(s[move.tar] + 1, n[move.tar]);
+          EXPECT_EQ(move.src / init.deme(), move.tar / init.deme());
+
+          actual.push_back(move.id);
+
+        });
+
+      ::std::sort(expected.begin(), expected.end());
+      ::std::sort(actual.begin(), actual.end());
+
+      EXPECT_EQ(expected, actual);
+
+    }
+
+  }
+
+}
+
+
+TEST_F(NeighborTableTest, Degree) {
+
+  for (auto const& init: {i2, i3}) {
+
+    NeighborTable table {StateSpace(init)};
+
+    ::std::vector<Index> ranks(unsign(init.deme()));
+
+    for (auto i = 0; i < init.dim(); ++i) {
+
+      table.ranks(i, ranks.data());
+
+      Index count = 0;
+
+      table.for_each(i, ranks.data(), [&](Move const&) { ++count; });
+
+      EXPECT_EQ(count, table.degree(ranks.data()));
+
+    }
+
+  }
+
+}
+
+
+TEST_F(NeighborTableTest, Rate) {
+
+  ::esf::Param param({0.0, 1.0, 0.5, 0.0}, {1.0, 1.5}, {0.2, 0.4});
+
+  NeighborTable table {StateSpace(i2)};
+
+  ::std::vector<Index> ranks(2);
+
+  State s(i2);
+
+  table.ranks(s.id(), ranks.data());
+
+  table.for_each(s.id(), ranks.data(), [&](Move const& move) {
+
+      EXPECT_DOUBLE_EQ(s[move.src] * param.mig_rate(move.src % 2, move.tar % 2),
+                       table.rate(move, param));
+
+    });
+
+}
+
+
+
+TEST_F(NeighborTableTest, BackRate) {
+
+  ::esf::Param param({0.0, 1.0, 0.5, 1.5, 0.0, 2.0, 2.5, 3.0, 0.0},
+                     {1.0, 1.5, 2.0}, {0.2, 0.4, 0.6});
+
+  NeighborTable table {StateSpace(i3)};
+
+  ::std::vector<Index> ranks(3), back(3);
+
+  for (auto i = 0; i < i3.dim(); ++i) {
+
+    table.ranks(i, ranks.data());
+
+    table.for_each(i, ranks.data(), [&](Move const& move) {
+
+        ASSERT_LT(move.index, table.moves());
+
+        // The reverse migration is the one from the neighbor, which
+        // leads back to the state.
+        auto count = 0;
+
+        table.ranks(move.id, back.data());
+
+        table.for_each(move.id, back.data(), [&](Move const& reverse) {
+
+            if (reverse.id == i) {
+
+              EXPECT_EQ(move.src, reverse.tar);
+              EXPECT_EQ(move.tar, reverse.src);
+              EXPECT_DOUBLE_EQ(table.rate(reverse, param),
+                               table.back_rate(move.index, param));
+
+              ++count;
+
+            }
+
+          });
+
+        EXPECT_EQ(1, count);
+
+      });
+
+  }
+
+}
+
+}
@@ -66,4 +66,24 @@ TEST_F(ParamTest, ThreeDemeMigration) {
 }
 
 
+TEST_F(ParamTest, Fingerprint) {
+
+  ::esf::Param copy(p2d);
+
+  EXPECT_EQ(p2d.fingerprint(), copy.fingerprint());
+  EXPECT_NE(p2d.fingerprint(), p3d.fingerprint());
+
+  copy.mut_rate(1) = 0.5;
+
+  EXPECT_NE(p2d.fingerprint(), copy.fingerprint());
+
+  // Negative zero is the same parameter as zero.
+  copy = p2d;
+  copy.mig_rate(0, 0) = -0.0;
+
+  EXPECT_EQ(p2d.fingerprint(), copy.fingerprint());
+
+}
+
+
 }
@@ -0,0 +1,175 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// reach_cache_test.cc - [unit test] ReachCache
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "afs.hh"
+#include "allele.hh"
+#include "reach_cache.hh"
+#include "state.hh"
+#include "thread_pool.hh"
+#include "util.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::AFS;
+using ::esf::Allele;
+using ::esf::Index;
+using ::esf::ReachCache;
+using ::esf::ThreadPool;
+using ::std::vector;
+
+
+TEST(ReachCacheTest, Exits) {
+
+  ReachCache cache;
+
+  AFS afs(vector<Allele>({Allele({2, 0}), Allele({1, 1})}));
+
+  auto expected = afs.reacheable();
+
+  auto const& exits = cache.exits(afs);
+
+  ASSERT_EQ(expected.size(), exits.size());
+
+  for (decltype(exits.size()) i = 0; i < exits.size(); ++i) {
+
+    EXPECT_EQ(expected[i].afs, *exits[i].afs);
+    EXPECT_EQ(expected[i].state.id(), exits[i].state);
+
+  }
+
+  EXPECT_EQ(&exits, &cache.exits(afs));
+
+}
+
+
+TEST(ReachCacheTest, SharedExits) {
+
+  ReachCache cache;
+
+  AFS a0(vector<Allele>({Allele({2, 0}), Allele({1, 1})}));
+  AFS a1(vector<Allele>({Allele({1, 1}), Allele({2, 0})}));
+  AFS a2(vector<Allele>({Allele({1, 1}), Allele({1, 1})}));
+
+  auto const& e0 = cache.exits(a0);
+  auto const& e2 = cache.exits(a2);
+
+  EXPECT_EQ(&e0, &cache.exits(a1));
+
+  // Both samples reach the one with all genes in the first deme.
+  AFS target(vector<Allele>({Allele({2, 0}), Allele({2, 0})}));
+
+  AFS const* p0 = nullptr;
+  AFS const* p2 = nullptr;
+
+  for (auto const& e: e0) {
+
+    if (*e.afs == target) p0 = e.afs;
+
+  }
+
+  for (auto const& e: e2) {
+
+    if (*e.afs == target) p2 = e.afs;
+
+  }
+
+  ASSERT_NE(nullptr, p0);
+  EXPECT_EQ(p0, p2);
+
+  cache.clear();
+
+  EXPECT_EQ(0u, cache.size());
+
+}
+
+
+TEST(ReachCacheTest, Shards) {
+
+  ReachCache one(1);
+  ReachCache many(7);
+
+  AFS afs(vector<Allele>({Allele({2, 1}), Allele({1, 2}), Allele({1, 0})}));
+
+  auto const& e1 = one.exits(afs);
+  auto const& e7 = many.exits(afs);
+
+  ASSERT_EQ(e1.size(), e7.size());
+
+  for (decltype(e1.size()) i = 0; i < e1.size(); ++i) {
+
+    EXPECT_EQ(*e1[i].afs, *e7[i].afs);
+    EXPECT_EQ(e1[i].state, e7[i].state);
+
+  }
+
+  EXPECT_EQ(one.size(), many.size());
+
+}
+
+
+TEST(ReachCacheTest, Threads) {
+
+  ReachCache cache;
+
+  ThreadPool pool(4);
+
+  vector<AFS> samples;
+
+  for (int i = 1; i <= 4; ++i) {
+
+    samples.push_back(AFS(vector<Allele>({Allele({i, 1}), Allele({1, i})})));
+
+  }
+
+  pool.parallel_for_each(
+      0, 64,
+      [&](Index i)
+      {
+        cache.exits(samples[::esf::unsign(i % 4)]);
+      });
+
+  for (auto const& afs: samples) {
+
+    auto expected = afs.reacheable();
+
+    auto const& exits = cache.exits(afs);
+
+    ASSERT_EQ(expected.size(), exits.size());
+
+    for (decltype(exits.size()) i = 0; i < exits.size(); ++i) {
+
+      EXPECT_EQ(expected[i].afs, *exits[i].afs);
+
+    }
+
+  }
+
+}
+
+
+}
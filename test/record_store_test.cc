@@ -0,0 +1,217 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// record_store_test.cc - [unit test] record_store
+
+// Copyright (C) 2013 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "record_store.hh"
+#include "temp_dir.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::RecordStore;
+
+char const magic[8] = {'R', 'E', 'C', 'O', 'R', 'D', 'S', ' '};
+
+char const other[8] = {'O', 'T', 'H', 'E', 'R', ' ', ' ', ' '};
+
+
+class RecordStoreTest: public ::testing::Test {
+
+ protected:
+
+  RecordStoreTest()
+      : dir(), path(dir.path("record.store")) {}
+
+  ::esf::test::TempDir dir;
+
+  ::std::string path;
+
+};
+
+
+TEST_F(RecordStoreTest, Values) {
+
+  ::std::vector<double> values = {0.5, 0.25, 0.125};
+
+  {
+    RecordStore store(path, magic, 2);
+
+    store.insert(7, {1, 2}, values.data(), values.size());
+    store.insert(7, {1}, values.data(), 1);
+    store.insert(7, {}, nullptr, 0);
+
+    EXPECT_EQ(3u, store.size());
+  }
+
+  RecordStore store(path, magic, 2);
+
+  ::std::size_t count;
+
+  auto found = store.find(7, {1, 2}, count);
+
+  ASSERT_NE(nullptr, found);
+  ASSERT_EQ(3u, count);
+
+  ::std::vector<double> loaded(count);
+
+  ::std::memcpy(loaded.data(), found, count * sizeof(double));
+
+  EXPECT_EQ(values, loaded);
+
+  ASSERT_NE(nullptr, store.find(7, {}, count));
+  EXPECT_EQ(0u, count);
+
+  EXPECT_EQ(nullptr, store.find(8, {1, 2}, count));
+  EXPECT_EQ(nullptr, store.find(7, {2, 1}, count));
+
+}
+
+
+TEST_F(RecordStoreTest, Batches) {
+
+  double value = 0.5;
+
+  RecordStore store(path, magic, 2);
+
+  for (::std::uint32_t i = 0; i < 5; ++i) {
+
+    store.insert(7, {i}, &value, 1);
+
+  }
+
+  // Batches are written to the data file without the index.
+  EXPECT_FALSE(::std::ifstream(path + ".idx").good());
+
+  {
+    RecordStore reader(path, magic, 2);
+
+    EXPECT_EQ(4u, reader.size());
+  }
+
+  ::std::size_t count;
+
+  for (::std::uint32_t i = 0; i < 5; ++i) {
+
+    EXPECT_NE(nullptr, store.find(7, {i}, count));
+
+  }
+
+  store.flush();
+
+  EXPECT_TRUE(::std::ifstream(path + ".idx").good());
+
+  RecordStore reader(path, magic, 2);
+
+  EXPECT_EQ(5u, reader.size());
+
+  for (::std::uint32_t i = 0; i < 5; ++i) {
+
+    EXPECT_NE(nullptr, reader.find(7, {i}, count));
+
+  }
+
+}
+
+
+TEST_F(RecordStoreTest, CorruptedIndex) {
+
+  double value = 0.5;
+
+  {
+    RecordStore store(path, magic, 1);
+
+    for (::std::uint32_t i = 0; i < 3; ++i) {
+
+      store.insert(7, {i}, &value, 1);
+
+    }
+  }
+
+  // Entries follow a header of 32 bytes, and each is a key and an
+  // offset.  The offset of the first entry is moved past the data.
+  {
+    ::std::fstream io(path + ".idx", ::std::ios::binary | ::std::ios::in | ::std::ios::out);
+
+    ::std::uint64_t offset = ::std::uint64_t(1) << 40;
+
+    io.seekp(32 + 8);
+    io.write(reinterpret_cast<char const*>(&offset), sizeof(offset));
+  }
+
+  RecordStore store(path, magic, 1);
+
+  EXPECT_EQ(3u, store.size());
+
+  ::std::size_t count;
+
+  for (::std::uint32_t i = 0; i < 3; ++i) {
+
+    auto found = store.find(7, {i}, count);
+
+    ASSERT_NE(nullptr, found);
+    EXPECT_EQ(1u, count);
+
+  }
+
+}
+
+
+TEST_F(RecordStoreTest, Kind) {
+
+  {
+    RecordStore store(path, magic, 1);
+  }
+
+  EXPECT_THROW(RecordStore store(path, other, 1), ::std::runtime_error);
+
+}
+
+
+
+TEST_F(RecordStoreTest, Version) {
+
+  // A store of the first version, whose records do not hold the
+  // number of values.
+  {
+    ::std::ofstream out(path, ::std::ios::binary);
+
+    ::std::uint32_t version = 1, byte_order = 0x01020304;
+
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<char const*>(&version), sizeof(version));
+    out.write(reinterpret_cast<char const*>(&byte_order), sizeof(byte_order));
+  }
+
+  EXPECT_THROW(RecordStore store(path, magic, 1), ::std::runtime_error);
+
+}
+
+}
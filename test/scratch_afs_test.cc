@@ -0,0 +1,188 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// scratch_afs_test.cc - [unit test] ScratchAFS
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "afs.hh"
+#include "afs_cache.hh"
+#include "afs_table.hh"
+#include "allele.hh"
+#include "scratch_afs.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::AFS;
+using ::esf::AFSCache;
+using ::esf::AFSTable;
+using ::esf::Allele;
+using ::esf::ScratchAFS;
+using ::std::vector;
+
+
+class ScratchAFSTest: public ::testing::Test {
+
+ protected:
+
+  ScratchAFSTest()
+      : a10({1, 0}), a01({0, 1}), a20({2, 0}), a11({1, 1}), a00({0, 0}),
+        base(vector<Allele>({a20, a11, a11, a01})) {}
+
+  Allele a10, a01, a20, a11, a00;
+
+  AFS base;
+
+};
+
+
+TEST_F(ScratchAFSTest, Copy) {
+
+  ScratchAFS scratch(base);
+
+  EXPECT_TRUE(scratch == base);
+  EXPECT_EQ(base.hash(), scratch.hash());
+  EXPECT_EQ(base.size(), scratch.size());
+  EXPECT_EQ(base.size(0), scratch.size(0));
+  EXPECT_EQ(base.size(1), scratch.size(1));
+  EXPECT_EQ(base.deme(), scratch.deme());
+  EXPECT_EQ(2, scratch[a11]);
+  EXPECT_EQ(base, scratch.afs());
+  EXPECT_EQ(0u, scratch.depth());
+
+}
+
+
+TEST_F(ScratchAFSTest, ApplyAndUndo) {
+
+  ScratchAFS scratch(base);
+
+  scratch.apply(a11, a10);
+
+  AFS expected = base.remove(a11).add(a10);
+
+  EXPECT_TRUE(scratch == expected);
+  EXPECT_EQ(expected.hash(), scratch.hash());
+  EXPECT_EQ(expected.size(), scratch.size());
+  EXPECT_EQ(expected.size(1), scratch.size(1));
+  EXPECT_EQ(1, scratch[a10]);
+
+  scratch.apply(a01, a20);
+
+  expected = expected.remove(a01).add(a20);
+
+  EXPECT_TRUE(expected == scratch);
+  EXPECT_EQ(expected.hash(), scratch.hash());
+  EXPECT_EQ(2u, scratch.depth());
+
+  scratch.undo();
+  scratch.undo();
+
+  EXPECT_TRUE(scratch == base);
+  EXPECT_EQ(base.hash(), scratch.hash());
+  EXPECT_EQ(base.size(0), scratch.size(0));
+  EXPECT_EQ(0u, scratch.depth());
+
+  // Nothing is left to undo.
+  scratch.undo();
+
+  EXPECT_TRUE(scratch == base);
+
+}
+
+
+TEST_F(ScratchAFSTest, Ignored) {
+
+  ScratchAFS scratch(base);
+
+  // An absent allele is not removed, and an empty one is not added.
+  scratch.apply(a10, a00);
+
+  EXPECT_TRUE(scratch == base);
+  EXPECT_EQ(base.hash(), scratch.hash());
+
+  scratch.apply(a20, a00);
+
+  EXPECT_TRUE(scratch == base.remove(a20));
+
+  scratch.undo();
+  scratch.undo();
+
+  EXPECT_TRUE(scratch == base);
+
+}
+
+
+TEST_F(ScratchAFSTest, Table) {
+
+  AFSTable table;
+
+  table.intern(base);
+
+  ScratchAFS scratch(base);
+
+  EXPECT_EQ(0u, table.find(scratch));
+  EXPECT_EQ(0u, table.intern(scratch));
+
+  scratch.apply(a11, a10);
+
+  EXPECT_EQ(AFSTable::npos, table.find(scratch));
+  EXPECT_EQ(1u, table.intern(scratch));
+  EXPECT_EQ(base.remove(a11).add(a10), table[1]);
+  EXPECT_EQ(1u, table.find(base.remove(a11).add(a10)));
+
+}
+
+
+TEST_F(ScratchAFSTest, Cache) {
+
+  AFSCache cache(base);
+
+  ScratchAFS scratch(base);
+
+  scratch.apply(a11, a10);
+
+  int calls = 0;
+
+  auto fn = [&calls](AFS const& afs)
+    {
+      ++calls;
+
+      return static_cast<double>(afs.size());
+    };
+
+  EXPECT_DOUBLE_EQ(6.0, cache.get_or_compute(scratch, fn));
+  EXPECT_DOUBLE_EQ(6.0, cache.get_or_compute(scratch, fn));
+  EXPECT_DOUBLE_EQ(6.0, cache.get_or_compute(scratch.afs(), []() { return 0.0; }));
+  EXPECT_EQ(1, calls);
+
+  auto stats = cache.stats();
+
+  EXPECT_EQ(2u, stats.hits);
+  EXPECT_EQ(1u, stats.misses);
+
+}
+
+
+}
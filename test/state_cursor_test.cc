@@ -0,0 +1,121 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// state_cursor_test.cc - [unit test] state_cursor
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <vector>
+
+#include "init.hh"
+#include "state.hh"
+#include "state_cursor.hh"
+#include "state_space.hh"
+#include "typedef.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Index;
+using ::esf::Init;
+using ::esf::State;
+using ::esf::StateCursor;
+using ::esf::StateSpace;
+
+
+class StateCursorTest: public ::testing::Test {
+
+ protected:
+
+  StateCursorTest()
+      : i1({4}), i2({2, 3}), i3({1, 2, 1}), i4({0, 2, 0, 1}) {}
+
+  Init i1, i2, i3, i4;
+
+};
+
+
+TEST_F(StateCursorTest, VisitAllStatesInOrder) {
+
+  for (auto const& init: {i1, i2, i3, i4}) {
+
+    StateSpace space(init);
+
+    Index count = 0;
+
+    for (StateCursor c(space); !c.done(); ++c) {
+
+      State s(init, count);
+
+      EXPECT_EQ(count, c.id());
+
+      Index size = init.deme() * init.deme();
+
+      for (Index j = 0; j < size; ++j) {
+
+        EXPECT_EQ(s[j], c[j]);
+
+      }
+
+      Init current(s);
+
+      for (Index d = 0; d < init.deme(); ++d) {
+
+        EXPECT_EQ(current[d], c.genes(d));
+
+        EXPECT_EQ(count / space.stride(d) % init.dim(d), c.rank(d));
+
+      }
+
+      ++count;
+
+    }
+
+    EXPECT_EQ(init.dim(), count);
+
+  }
+
+}
+
+
+TEST_F(StateCursorTest, StartFromMiddle) {
+
+  StateSpace space(i3);
+
+  for (Index start = 0; start < i3.dim(); ++start) {
+
+    StateCursor c(space, start);
+
+    for (auto j = start; j < i3.dim(); ++j, ++c) {
+
+      EXPECT_EQ(j, c.id());
+      EXPECT_EQ(State(i3, j), State(i3, ::std::vector<Index>(c.data(), c.data() + 9)));
+
+    }
+
+    EXPECT_TRUE(c.done());
+
+  }
+
+}
+
+
+}
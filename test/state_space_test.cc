@@ -0,0 +1,133 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// state_space_test.cc - [unit test] state_space
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <memory>
+#include <vector>
+
+#include "init.hh"
+#include "state.hh"
+#include "state_space.hh"
+#include "typedef.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Index;
+using ::esf::Init;
+using ::esf::State;
+using ::esf::StateSpace;
+
+
+class StateSpaceTest: public ::testing::Test {
+
+ protected:
+
+  StateSpaceTest()
+      : i2({2, 3}), i3({1, 2, 1}) {}
+
+  Init i2, i3;
+
+};
+
+
+TEST_F(StateSpaceTest, Stride) {
+
+  StateSpace s2(i2), s3(i3);
+
+  EXPECT_EQ(1, s2.stride(0));
+  EXPECT_EQ(3, s2.stride(1));
+
+  EXPECT_EQ(1, s3.stride(0));
+  EXPECT_EQ(3, s3.stride(1));
+  EXPECT_EQ(18, s3.stride(2));
+
+  EXPECT_EQ(i2.dim(), s2.dim());
+  EXPECT_EQ(i3.dim(), s3.dim());
+
+}
+
+
+TEST_F(StateSpaceTest, DecodeAndEncode) {
+
+  for (auto const& init: {i2, i3}) {
+
+    StateSpace space(init);
+
+    ::std::vector<Index> data(::esf::unsign(init.deme() * init.deme()));
+
+    for (auto i = 0; i < init.dim(); ++i) {
+
+      space.decode(i, data.data());
+
+      State s(init, i);
+
+      EXPECT_EQ(::std::vector<Index>(s.begin(), s.end()), data);
+      EXPECT_EQ(i, space.encode(data.data()));
+
+    }
+
+  }
+
+}
+
+
+TEST_F(StateSpaceTest, RankAndUnrank) {
+
+  StateSpace space(i3);
+
+  ::std::vector<Index> comp(3);
+
+  // Compositions of four genes over three demes.
+  for (Index r = 0; r < 15; ++r) {
+
+    space.unrank(r, 4, comp.data());
+
+    EXPECT_EQ(4, comp[0] + comp[1] + comp[2]);
+    EXPECT_EQ(r, space.rank(comp.data()));
+
+  }
+
+}
+
+
+TEST_F(StateSpaceTest, SharedByStates) {
+
+  auto space = ::std::make_shared<StateSpace const>(i3);
+
+  State s(space, 5);
+
+  EXPECT_EQ(space, s.space());
+  EXPECT_EQ(State(i3, 5), s);
+
+  for (auto const& adj: s.neighbors()) {
+
+    EXPECT_EQ(space, adj.space());
+
+  }
+
+}
+
+
+}
@@ -0,0 +1,119 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// temp_dir.hh - [unit test] Temporary directory for files written by tests
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef ESF_MULTI_TEMP_DIR_HH
+#define ESF_MULTI_TEMP_DIR_HH
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <unistd.h>
+
+namespace esf {
+
+namespace test {
+
+
+// This class creates a new directory under $TMPDIR, or /tmp if it is
+// not set, and removes the directory with all files in it on
+// destruction.  Tests write files in their own directory, so that
+// they do not clash with each other or with files in the working
+// directory, and nothing is left there when a test fails.
+class TempDir {
+
+ private:
+
+  ::std::string m_path;
+
+ public:
+
+  TempDir() {
+
+    auto base = ::std::getenv("TMPDIR");
+
+    ::std::string pattern = ::std::string(base && *base ? base : "/tmp") + "/esf_test.XXXXXX";
+
+    ::std::vector<char> buffer(pattern.begin(), pattern.end());
+
+    buffer.push_back('\0');
+
+    if (!::mkdtemp(buffer.data())) {
+
+      throw ::std::runtime_error("cannot create a temporary directory: " + pattern);
+
+    }
+
+    m_path = buffer.data();
+
+  }
+
+  TempDir(TempDir const&) = delete;
+
+  TempDir& operator=(TempDir const&) = delete;
+
+  ~TempDir() {
+
+    if (auto dir = ::opendir(m_path.c_str())) {
+
+      while (auto entry = ::readdir(dir)) {
+
+        ::std::string name(entry->d_name);
+
+        if (name != "." && name != "..") {
+
+          ::std::remove(path(name).c_str());
+
+        }
+
+      }
+
+      ::closedir(dir);
+
+    }
+
+    ::rmdir(m_path.c_str());
+
+  }
+
+  // Returns the path of a file in the directory.
+  ::std::string path(::std::string const& name) const {
+
+    return m_path + "/" + name;
+
+  }
+
+};
+
+
+}
+
+}
+
+
+#endif // ESF_MULTI_TEMP_DIR_HH
@@ -0,0 +1,208 @@
+// -*- mode: c++; coding: utf-8; -*-
+
+// thread_pool_test.cc - [unit test] thread_pool
+
+// Copyright (C) 2014 Seiji Kumagai
+
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following conditions:
+
+// The above copyright notice and this permission notice (including the next
+// paragraph) shall be included in all copies or substantial portions of the
+// Software.
+
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "thread_pool.hh"
+#include "typedef.hh"
+#include "util.hh"
+#include "gtest/gtest.h"
+
+namespace {
+
+using ::esf::Index;
+
+
+class ThreadPoolTest: public ::testing::Test {
+
+ protected:
+
+  ThreadPoolTest() {}
+
+};
+
+
+TEST_F(ThreadPoolTest, Size) {
+
+  EXPECT_EQ(1, ::esf::ThreadPool(1).size());
+  EXPECT_EQ(3, ::esf::ThreadPool(3).size());
+  EXPECT_LE(1, ::esf::ThreadPool().size());
+
+}
+
+
+TEST_F(ThreadPoolTest, VisitEveryIndexOnce) {
+
+  for (Index threads = 1; threads <= 4; ++threads) {
+
+    ::esf::ThreadPool pool(threads);
+
+    for (Index chunk: {1, 3, 7, 100}) {
+
+      ::std::vector<::std::atomic<int>> count(50);
+
+      for (auto& c: count) {
+
+        c = 0;
+
+      }
+
+      pool.parallel_for(5, 50, chunk,
+                        [&count](Index b, Index e)
+                        {
+                          for (auto i = b; i < e; ++i) {
+
+                            ++count[::esf::unsign(i)];
+
+                          }
+                        });
+
+      for (Index i = 0; i < 50; ++i) {
+
+        EXPECT_EQ(i < 5 ? 0 : 1, count[::esf::unsign(i)]);
+
+      }
+
+    }
+
+  }
+
+}
+
+
+TEST_F(ThreadPoolTest, EmptyRange) {
+
+  ::esf::ThreadPool pool(2);
+
+  bool called = false;
+
+  pool.parallel_for(3, 3, 1, [&called](Index, Index) { called = true; });
+
+  EXPECT_FALSE(called);
+
+}
+
+
+TEST_F(ThreadPoolTest, StealWork) {
+
+  for (Index threads = 1; threads <= 4; ++threads) {
+
+    ::esf::ThreadPool pool(threads);
+
+    for (Index n: {1, 2, 5, 64}) {
+
+      ::std::vector<::std::atomic<int>> count(::esf::unsign(n));
+
+      for (auto& c: count) {
+
+        c = 0;
+
+      }
+
+      // The first few indices are far more expensive than the rest.
+      pool.parallel_for_each(0, n,
+                             [&count](Index i)
+                             {
+                               if (i < 2) {
+
+                                 ::std::this_thread::sleep_for(
+                                     ::std::chrono::milliseconds(5));
+
+                               }
+
+                               ++count[::esf::unsign(i)];
+                             });
+
+      for (auto const& c: count) {
+
+        EXPECT_EQ(1, c);
+
+      }
+
+    }
+
+    bool called = false;
+
+    pool.parallel_for_each(2, 2, [&called](Index) { called = true; });
+
+    EXPECT_FALSE(called);
+
+  }
+
+}
+
+
+TEST_F(ThreadPoolTest, Throw) {
+
+  for (Index threads: {1, 2, 4}) {
+
+    ::esf::ThreadPool pool(threads);
+
+    ::std::atomic<Index> calls(0);
+
+    EXPECT_THROW(pool.parallel_for_each(0, 1000,
+                                        [&calls](Index i)
+                                        {
+                                          ++calls;
+
+                                          if (i % 100 == 7) {
+
+                                            throw ::std::runtime_error("each");
+
+                                          }
+                                        }),
+                 ::std::runtime_error);
+
+    // Indices stop being handed out after the first exception.
+    EXPECT_GT(1000, calls.load());
+
+    EXPECT_THROW(pool.parallel_for(0, 1000, 10,
+                                   [](Index b, Index)
+                                   {
+                                     if (b == 0) {
+
+                                       throw ::std::length_error("chunk");
+
+                                     }
+                                   }),
+                 ::std::length_error);
+
+    // The pool is still usable.
+    ::std::atomic<Index> sum(0);
+
+    pool.parallel_for_each(0, 100, [&sum](Index i) { sum += i; });
+
+    EXPECT_EQ(4950, sum.load());
+
+  }
+
+}
+
+
+}